@@ -0,0 +1,222 @@
+/* buffer_cache.c: Sector cache between the file system and the disk.
+ *
+ * inode_read_at()과 inode_write_at()은 sector 하나를 읽고 쓸 때마다 disk에
+ * 직접 갔고, sector 일부만 쓸 때는 bounce buffer에 읽어서 고친 뒤 다시 썼다.
+ * 이제 모든 sector I/O는 BUFFER_CACHE_SIZE개 entry의 cache를 거친다.
+ * 교체는 clock 알고리즘으로 하고, 쓰기는 entry를 dirty로 표시만 해두었다가
+ * evict될 때, write-behind 스레드가 주기적으로, 그리고 filesys_done()에서
+ * disk에 쓴다. 순차적으로 읽는 reader를 위해 다음 sector를 read-ahead
+ * 스레드가 미리 읽어 둔다. */
+
+#include "filesys/buffer_cache.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "filesys/filesys.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* A cached sector. */
+struct cache_entry {
+	disk_sector_t sector;
+	bool valid;				/* sector를 담고 있는지 */
+	bool dirty;				/* disk에 아직 안 쓴 내용이 있는지 */
+	bool accessed;			/* clock hand가 지나간 뒤 쓰였는지 */
+	uint8_t data[DISK_SECTOR_SIZE];
+};
+
+/* Sectors waiting to be read ahead. */
+#define READAHEAD_QUEUE 16
+
+static struct cache_entry cache[BUFFER_CACHE_SIZE];
+static struct lock cache_lock;
+static size_t hand;						/* clock hand */
+static unsigned writeback_seq;			/* dirty entry를 disk에 쓸 때마다 증가 */
+
+static disk_sector_t ra_queue[READAHEAD_QUEUE];
+static size_t ra_head, ra_cnt;
+static struct semaphore ra_sema;
+
+/* Statistics. */
+static long long hit_cnt;		/* cache에서 찾은 횟수 */
+static long long miss_cnt;		/* disk까지 가야 했던 횟수 */
+static long long write_cnt;		/* disk에 쓴 dirty sector 수 */
+static long long readahead_cnt;	/* 미리 읽어둔 sector 수 */
+
+static struct cache_entry *lookup (disk_sector_t sector);
+static struct cache_entry *get_entry (disk_sector_t sector, bool load);
+static struct cache_entry *evict (void);
+static void write_back (struct cache_entry *e);
+static void write_behind (void *aux);
+static void read_ahead (void *aux);
+
+/* Starts the write-behind and read-ahead threads. */
+void
+buffer_cache_init (void) {
+	lock_init (&cache_lock);
+	sema_init (&ra_sema, 0);
+	thread_create ("bc_flush", PRI_DEFAULT, write_behind, NULL);
+	thread_create ("bc_readahead", PRI_DEFAULT, read_ahead, NULL);
+}
+
+/* Copies SIZE bytes at offset OFS of SECTOR into BUFFER. */
+void
+buffer_cache_read (disk_sector_t sector, void *buffer, off_t ofs,
+		size_t size) {
+	ASSERT (ofs >= 0 && ofs + size <= DISK_SECTOR_SIZE);
+
+	lock_acquire (&cache_lock);
+	struct cache_entry *e = get_entry (sector, true);
+	memcpy (buffer, e->data + ofs, size);
+	lock_release (&cache_lock);
+}
+
+/* Copies SIZE bytes from BUFFER to offset OFS of SECTOR. The sector
+ * reaches the disk later. */
+void
+buffer_cache_write (disk_sector_t sector, const void *buffer, off_t ofs,
+		size_t size) {
+	ASSERT (ofs >= 0 && ofs + size <= DISK_SECTOR_SIZE);
+
+	lock_acquire (&cache_lock);
+	// sector 전체를 덮어쓰면 disk에서 읽어올 필요가 없다
+	struct cache_entry *e = get_entry (sector, size < DISK_SECTOR_SIZE);
+	memcpy (e->data + ofs, buffer, size);
+	e->dirty = true;
+	lock_release (&cache_lock);
+}
+
+/* Asks the read-ahead thread to bring SECTOR into the cache. Returns
+ * at once; the request is dropped if the queue is full. */
+void
+buffer_cache_readahead (disk_sector_t sector) {
+	lock_acquire (&cache_lock);
+	if (lookup (sector) == NULL && ra_cnt < READAHEAD_QUEUE) {
+		ra_queue[(ra_head + ra_cnt++) % READAHEAD_QUEUE] = sector;
+		sema_up (&ra_sema);
+	}
+	lock_release (&cache_lock);
+}
+
+/* Writes every dirty sector to the disk. */
+void
+buffer_cache_flush (void) {
+	lock_acquire (&cache_lock);
+	for (size_t i = 0; i < BUFFER_CACHE_SIZE; i++)
+		if (cache[i].valid && cache[i].dirty)
+			write_back (&cache[i]);
+	lock_release (&cache_lock);
+}
+
+void
+buffer_cache_print_stats (void) {
+	printf ("Buffer cache: %lld hits, %lld misses, %lld written, "
+			"%lld read ahead\n", hit_cnt, miss_cnt, write_cnt, readahead_cnt);
+}
+
+static struct cache_entry *
+lookup (disk_sector_t sector) {
+	for (size_t i = 0; i < BUFFER_CACHE_SIZE; i++)
+		if (cache[i].valid && cache[i].sector == sector)
+			return &cache[i];
+	return NULL;
+}
+
+/* Returns the entry holding SECTOR, making room for it if it is not
+ * cached. A new entry is read from the disk only if LOAD is true.
+ * Must be called with cache_lock held. */
+static struct cache_entry *
+get_entry (disk_sector_t sector, bool load) {
+	struct cache_entry *e = lookup (sector);
+
+	if (e != NULL)
+		hit_cnt++;
+	else {
+		miss_cnt++;
+		e = evict ();
+		if (load)
+			disk_read (filesys_disk, sector, e->data);
+		e->sector = sector;
+		e->valid = true;
+		e->dirty = false;
+	}
+	e->accessed = true;
+	return e;
+}
+
+/* Picks an entry with the clock algorithm, writes it back if it is
+ * dirty and returns it invalidated. Must be called with cache_lock
+ * held. */
+static struct cache_entry *
+evict (void) {
+	for (;;) {
+		struct cache_entry *e = &cache[hand];
+		hand = (hand + 1) % BUFFER_CACHE_SIZE;
+		if (!e->valid)
+			return e;
+		if (e->accessed) {
+			e->accessed = false;	// 한 바퀴 더 기회를 준다
+			continue;
+		}
+		if (e->dirty)
+			write_back (e);
+		e->valid = false;
+		return e;
+	}
+}
+
+static void
+write_back (struct cache_entry *e) {
+	disk_write (filesys_disk, e->sector, e->data);
+	e->dirty = false;
+	writeback_seq++;
+	write_cnt++;
+}
+
+/* Flushes dirty sectors every WRITE_BEHIND_TICKS so that a crash loses
+ * at most that much work. */
+static void
+write_behind (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (WRITE_BEHIND_TICKS);
+		buffer_cache_flush ();
+	}
+}
+
+/* Reads queued sectors into the cache. The disk read happens without
+ * cache_lock so that other threads keep using the cache meanwhile. */
+static void
+read_ahead (void *aux UNUSED) {
+	static uint8_t buf[DISK_SECTOR_SIZE];
+
+	for (;;) {
+		sema_down (&ra_sema);
+
+		lock_acquire (&cache_lock);
+		disk_sector_t sector = ra_queue[ra_head];
+		ra_head = (ra_head + 1) % READAHEAD_QUEUE;
+		ra_cnt--;
+		unsigned seq = writeback_seq;
+		bool cached = lookup (sector) != NULL;
+		lock_release (&cache_lock);
+		if (cached)
+			continue;
+
+		disk_read (filesys_disk, sector, buf);
+
+		lock_acquire (&cache_lock);
+		// 읽는 동안 누가 이 sector를 cache에 올렸거나, 고쳐서 disk에 쓰고
+		// evict했을 수 있다. 둘 다 아닐 때만 읽은 내용이 최신이다.
+		if (lookup (sector) == NULL && seq == writeback_seq) {
+			struct cache_entry *e = evict ();
+			memcpy (e->data, buf, DISK_SECTOR_SIZE);
+			e->sector = sector;
+			e->valid = true;
+			e->dirty = false;
+			e->accessed = false;	// 실제로 읽히기 전에는 먼저 밀려나도 된다
+			readahead_cnt++;
+		}
+		lock_release (&cache_lock);
+	}
+}
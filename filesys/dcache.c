@@ -0,0 +1,184 @@
+/* dcache.c: Cache of directory entries.
+ *
+ * parse_path()는 경로의 component마다 dir_lookup()을 불러서 디렉토리를
+ * 읽었다. 이제 dir_lookup()은 (디렉토리 inode의 sector, 이름) -> 파일의
+ * inode sector를 이 cache에서 먼저 찾는다. 없는 이름도 기억해 두므로
+ * (negative entry) 없는 파일을 여는 것도 디렉토리를 읽지 않는다.
+ * dir_add()와 dir_remove()가 바꾼 이름은 지우고, 새로 만든 디렉토리의
+ * sector에 대해 남아있던 것도 모두 지운다. 가득 차면 가장 오래 안 쓰인
+ * 것부터 밀려난다. */
+
+#include "filesys/dcache.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/directory.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* A cached name. */
+struct dentry {
+	disk_sector_t dir;              /* key: 디렉토리 inode의 sector */
+	char name[NAME_MAX + 1];        /* key: 디렉토리 안의 이름 */
+	bool found;                     /* false면 이 이름은 없음 */
+	disk_sector_t sector;           /* 이름이 가리키는 inode의 sector */
+	struct hash_elem elem;          /* dentries의 element */
+	struct list_elem lru_elem;      /* lru의 element, 앞쪽이 최근 */
+};
+
+static struct hash dentries;
+static struct list lru;
+static size_t dentry_cnt;
+static struct lock dcache_lock;
+
+/* Statistics. */
+static long long hit_cnt;           /* 있는 이름을 cache에서 찾은 횟수 */
+static long long negative_cnt;      /* 없는 이름을 cache에서 찾은 횟수 */
+static long long miss_cnt;          /* 디렉토리를 읽어야 했던 횟수 */
+
+static struct dentry *find (disk_sector_t dir, const char *name);
+static void drop (struct dentry *d);
+static uint64_t dentry_hash (const struct hash_elem *e, void *aux);
+static bool dentry_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux);
+
+void
+dcache_init (void) {
+	hash_init (&dentries, dentry_hash, dentry_less, NULL);
+	list_init (&lru);
+	lock_init (&dcache_lock);
+}
+
+/* Looks up NAME in the directory whose inode is at DIR. On DCACHE_FOUND
+ * the inode sector of NAME is stored in *SECTOR. */
+enum dcache_result
+dcache_lookup (disk_sector_t dir, const char *name, disk_sector_t *sector) {
+	enum dcache_result result = DCACHE_MISS;
+
+	lock_acquire (&dcache_lock);
+	struct dentry *d = find (dir, name);
+	if (d == NULL)
+		miss_cnt++;
+	else {
+		list_remove (&d->lru_elem);
+		list_push_front (&lru, &d->lru_elem);
+		if (d->found) {
+			*sector = d->sector;
+			result = DCACHE_FOUND;
+			hit_cnt++;
+		} else {
+			result = DCACHE_ABSENT;
+			negative_cnt++;
+		}
+	}
+	lock_release (&dcache_lock);
+	return result;
+}
+
+/* Remembers that NAME in DIR is the inode at SECTOR, or that there is
+ * no NAME in DIR if FOUND is false. */
+void
+dcache_insert (disk_sector_t dir, const char *name, bool found,
+		disk_sector_t sector) {
+	if (strlen (name) > NAME_MAX)
+		return;
+
+	lock_acquire (&dcache_lock);
+	struct dentry *d = find (dir, name);
+	if (d != NULL)
+		list_remove (&d->lru_elem);
+	else {
+		if (dentry_cnt >= DCACHE_SIZE)
+			// 가장 오래 안 쓰인 것을 재사용
+			d = list_entry (list_back (&lru), struct dentry, lru_elem);
+		else
+			d = malloc (sizeof *d);
+		if (d == NULL)
+			goto done;
+		if (dentry_cnt >= DCACHE_SIZE) {
+			list_remove (&d->lru_elem);
+			hash_delete (&dentries, &d->elem);
+		} else
+			dentry_cnt++;
+		d->dir = dir;
+		strlcpy (d->name, name, sizeof d->name);
+		hash_insert (&dentries, &d->elem);
+	}
+	d->found = found;
+	d->sector = sector;
+	list_push_front (&lru, &d->lru_elem);
+done:
+	lock_release (&dcache_lock);
+}
+
+/* Forgets NAME in DIR. Called whenever the entry changes on disk. */
+void
+dcache_invalidate (disk_sector_t dir, const char *name) {
+	lock_acquire (&dcache_lock);
+	struct dentry *d = find (dir, name);
+	if (d != NULL)
+		drop (d);
+	lock_release (&dcache_lock);
+}
+
+/* Forgets every name in DIR. A new directory may use the sector of one
+ * that was removed, so this is called when a directory is created. */
+void
+dcache_purge (disk_sector_t dir) {
+	lock_acquire (&dcache_lock);
+	for (struct list_elem *e = list_begin (&lru); e != list_end (&lru);) {
+		struct dentry *d = list_entry (e, struct dentry, lru_elem);
+		e = list_next (e);
+		if (d->dir == dir)
+			drop (d);
+	}
+	lock_release (&dcache_lock);
+}
+
+void
+dcache_print_stats (void) {
+	printf ("Dentry cache: %lld hits, %lld negative hits, %lld misses\n",
+			hit_cnt, negative_cnt, miss_cnt);
+}
+
+/* Must be called with dcache_lock held. */
+static struct dentry *
+find (disk_sector_t dir, const char *name) {
+	struct dentry key;
+	struct hash_elem *e;
+
+	if (strlen (name) > NAME_MAX)
+		return NULL;
+	key.dir = dir;
+	strlcpy (key.name, name, sizeof key.name);
+	e = hash_find (&dentries, &key.elem);
+	return e != NULL ? hash_entry (e, struct dentry, elem) : NULL;
+}
+
+/* Must be called with dcache_lock held. */
+static void
+drop (struct dentry *d) {
+	hash_delete (&dentries, &d->elem);
+	list_remove (&d->lru_elem);
+	dentry_cnt--;
+	free (d);
+}
+
+static uint64_t
+dentry_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct dentry *d = hash_entry (e, struct dentry, elem);
+	return hash_string (d->name) ^ hash_int (d->dir);
+}
+
+static bool
+dentry_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct dentry *a = hash_entry (a_, struct dentry, elem);
+	const struct dentry *b = hash_entry (b_, struct dentry, elem);
+
+	if (a->dir != b->dir)
+		return a->dir < b->dir;
+	return strcmp (a->name, b->name) < 0;
+}
@@ -2,7 +2,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <list.h>
+#include <hash.h>
+#include <round.h>
 #include "filesys/filesys.h"
+#include "filesys/dcache.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
 #include "filesys/fat.h"
@@ -23,11 +26,72 @@ struct dir_entry {
 	bool in_use;                        /* In use or free? */
 };
 
+/* Directories are kept in one of two formats.
+ *
+ * A linear directory is an array of dir_entry, searched from the start.
+ * Directories made before the hashed format existed are linear, and are
+ * still read and written that way.
+ *
+ * A hashed directory starts with a dir_header sector followed by
+ * bucket_cnt buckets of one sector each. A name goes to the bucket its
+ * hash picks, or to the following ones if that bucket is full (linear
+ * probing by bucket), so a lookup usually reads the header and a single
+ * bucket. A free slot whose name is empty has never been used and ends
+ * the probe; one that keeps its name was removed and does not. The
+ * buckets are rehashed into twice as many when 3/4 of the slots have
+ * been used. */
+
+/* Marks a hashed directory. Larger than any sector number, so it cannot
+ * be mistaken for the first entry of a linear directory. */
+#define DIR_MAGIC 0x48534944
+
+/* Number of slots in a bucket. */
+#define BUCKET_SLOTS (DISK_SECTOR_SIZE / sizeof (struct dir_entry))
+
+/* First sector of a hashed directory. */
+struct dir_header {
+	uint32_t magic;                     /* DIR_MAGIC. */
+	uint32_t bucket_cnt;                /* Number of buckets. */
+	uint32_t used_cnt;                  /* 한 번이라도 쓰인 slot 수 */
+	uint32_t live_cnt;                  /* 지금 in_use인 slot 수 */
+};
+
+/* A bucket of a hashed directory. */
+struct dir_bucket {
+	struct dir_entry slots[BUCKET_SLOTS];
+};
+
+static bool read_header (const struct dir *, struct dir_header *);
+static bool write_header (struct dir *, const struct dir_header *);
+static off_t bucket_ofs (size_t bucket);
+static bool hashed_lookup (const struct dir *, const struct dir_header *,
+		const char *name, struct dir_entry *ep, off_t *ofsp);
+static bool hashed_insert (struct dir *, struct dir_header *,
+		const struct dir_entry *);
+static bool rehash (struct dir *, struct dir_header *, size_t bucket_cnt);
+
 /* Creates a directory with space for ENTRY_CNT entries in the
  * given SECTOR.  Returns true if successful, false on failure. */
 bool
 dir_create (disk_sector_t sector, size_t entry_cnt) {
-	return inode_create (sector, entry_cnt * sizeof (struct dir_entry), 1);
+	struct dir_header h = { .magic = DIR_MAGIC, .used_cnt = 0, .live_cnt = 0 };
+	struct dir *dir;
+	bool success;
+
+	// 새 디렉토리는 hashed 형식으로 만든다 (bucket은 0으로 채워짐)
+	h.bucket_cnt = DIV_ROUND_UP (entry_cnt, BUCKET_SLOTS);
+	if (h.bucket_cnt == 0)
+		h.bucket_cnt = 1;
+	if (!inode_create (sector, bucket_ofs (h.bucket_cnt), 1))
+		return false;
+	dir = dir_open (inode_open (sector));
+	if (dir == NULL)
+		return false;
+	success = write_header (dir, &h);
+	dir_close (dir);
+	// 지워진 디렉토리의 sector를 다시 쓰는 경우 그 이름들이 남아있으면 안 됨
+	dcache_purge (sector);
+	return success;
 }
 
 /* Opens and returns the directory for the given INODE, of which
@@ -93,12 +157,16 @@ dir_get_inode (struct dir *dir) {
 static bool
 lookup (const struct dir *dir, const char *name,
 		struct dir_entry *ep, off_t *ofsp) {
+	struct dir_header h;
 	struct dir_entry e;
 	size_t ofs;
 
 	ASSERT (dir != NULL);
 	ASSERT (name != NULL);
 
+	if (read_header (dir, &h))
+		return hashed_lookup (dir, &h, name, ep, ofsp);
+
 	for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
 			ofs += sizeof e)
 		if (e.in_use && !strcmp (name, e.name)) {
@@ -119,15 +187,30 @@ lookup (const struct dir *dir, const char *name,
 bool
 dir_lookup (const struct dir *dir, const char *name,
 		struct inode **inode) {
+	disk_sector_t parent, sector;
 	struct dir_entry e;
 
 	ASSERT (dir != NULL);
 	ASSERT (name != NULL);
 
-	if (lookup (dir, name, &e, NULL))
-		*inode = inode_open (e.inode_sector);
-	else
-		*inode = NULL;
+	parent = inode_get_inumber (dir->inode);
+	// dentry cache에 있으면 디렉토리를 읽지 않는다
+	switch (dcache_lookup (parent, name, &sector)) {
+		case DCACHE_FOUND:
+			*inode = inode_open (sector);
+			break;
+		case DCACHE_ABSENT:
+			*inode = NULL;
+			break;
+		default:
+			if (lookup (dir, name, &e, NULL)) {
+				dcache_insert (parent, name, true, e.inode_sector);
+				*inode = inode_open (e.inode_sector);
+			} else {
+				dcache_insert (parent, name, false, 0);
+				*inode = NULL;
+			}
+	}
 
 	return *inode != NULL;
 }
@@ -142,6 +225,7 @@ dir_lookup (const struct dir *dir, const char *name,
 bool 
 dir_add (struct dir *dir, const char *name, disk_sector_t inode_sector) {
 	
+	struct dir_header h;
 	struct dir_entry e;
 	off_t ofs;
 	bool success = false;
@@ -158,6 +242,23 @@ dir_add (struct dir *dir, const char *name, disk_sector_t inode_sector) {
 	// 현 dir에 name을 가진 file이 있는지 bool을 반환
 	if (lookup (dir, name, NULL, NULL))
 		goto done;
+	dcache_invalidate (inode_get_inumber (dir->inode), name);
+
+	if (read_header (dir, &h)) {
+		e.in_use = true;
+		strlcpy (e.name, name, sizeof e.name);
+		e.inode_sector = inode_sector;
+		// 3/4 이상 찼으면 bucket을 늘려서 다시 나눈다.
+		// 지워진 slot이 많아서 찬 것이면 크기는 그대로 두고 정리만 한다.
+		if ((h.used_cnt + 1) * 4 > h.bucket_cnt * BUCKET_SLOTS * 3) {
+			size_t cnt = (h.live_cnt + 1) * 2 > h.bucket_cnt * BUCKET_SLOTS
+				? h.bucket_cnt * 2 : h.bucket_cnt;
+			if (!rehash (dir, &h, cnt))
+				goto done;
+		}
+		success = hashed_insert (dir, &h, &e) && write_header (dir, &h);
+		goto done;
+	}
 
 	/* Set OFS to offset of free slot.
 	 * If there are no free slots, then it will be set to the
@@ -208,9 +309,17 @@ dir_remove (struct dir *dir, const char *name) {
 		goto done;
 
 	/* Erase directory entry. */
+	dcache_invalidate (inode_get_inumber (dir->inode), name);
+	// 이름은 남겨둔다: hashed 디렉토리에서 probe가 여기서 멈추지 않도록
 	e.in_use = false;
 	if (inode_write_at (dir->inode, &e, sizeof e, ofs) != sizeof e)
 		goto done;
+	struct dir_header h;
+	if (read_header (dir, &h)) {
+		h.live_cnt--;
+		if (!write_header (dir, &h))
+			goto done;
+	}
 
 	/* Remove inode. */
 	inode_remove (inode);
@@ -226,10 +335,17 @@ done:
  * contains no more entries. */
 bool
 dir_readdir (struct dir *dir, char name[NAME_MAX + 1]) {
+	struct dir_header h;
 	struct dir_entry e;
+	bool hashed = read_header (dir, &h);
 
+	// hashed 디렉토리는 header를 건너뛰고, bucket 끝에 남는 byte도 건너뛴다
+	if (hashed && dir->pos < bucket_ofs (0))
+		dir->pos = bucket_ofs (0);
 	while (inode_read_at (dir->inode, &e, sizeof e, dir->pos) == sizeof e) {
 		dir->pos += sizeof e;
+		if (hashed && dir->pos % DISK_SECTOR_SIZE + sizeof e > DISK_SECTOR_SIZE)
+			dir->pos = ROUND_UP (dir->pos, DISK_SECTOR_SIZE);
 		if (e.in_use) {
 			strlcpy (name, e.name, NAME_MAX + 1);
 			return true;
@@ -237,3 +353,113 @@ dir_readdir (struct dir *dir, char name[NAME_MAX + 1]) {
 	}
 	return false;
 }
+
+/* Reads DIR's header into *H. Returns false if DIR is linear. */
+static bool
+read_header (const struct dir *dir, struct dir_header *h) {
+	return inode_read_at (dir->inode, h, sizeof *h, 0) == sizeof *h
+		&& h->magic == DIR_MAGIC;
+}
+
+static bool
+write_header (struct dir *dir, const struct dir_header *h) {
+	return inode_write_at (dir->inode, h, sizeof *h, 0) == sizeof *h;
+}
+
+/* Returns the byte offset of BUCKET in a hashed directory. */
+static off_t
+bucket_ofs (size_t bucket) {
+	return (bucket + 1) * DISK_SECTOR_SIZE;
+}
+
+/* lookup() for a hashed directory with header H. */
+static bool
+hashed_lookup (const struct dir *dir, const struct dir_header *h,
+		const char *name, struct dir_entry *ep, off_t *ofsp) {
+	struct dir_bucket b;
+	size_t bucket = hash_string (name) % h->bucket_cnt;
+
+	for (size_t i = 0; i < h->bucket_cnt; i++) {
+		off_t ofs = bucket_ofs (bucket);
+		if (inode_read_at (dir->inode, &b, sizeof b, ofs) != sizeof b)
+			return false;
+		for (size_t j = 0; j < BUCKET_SLOTS; j++) {
+			struct dir_entry *e = &b.slots[j];
+			if (e->in_use && !strcmp (name, e->name)) {
+				if (ep != NULL)
+					*ep = *e;
+				if (ofsp != NULL)
+					*ofsp = ofs + j * sizeof *e;
+				return true;
+			}
+			if (!e->in_use && e->name[0] == '\0')
+				return false;	// 한 번도 안 쓰인 slot, 이 뒤로는 없음
+		}
+		bucket = (bucket + 1) % h->bucket_cnt;
+	}
+	return false;
+}
+
+/* Puts E in the first free slot on its probe sequence and updates the
+ * counts in H. The header itself is not written. */
+static bool
+hashed_insert (struct dir *dir, struct dir_header *h,
+		const struct dir_entry *e) {
+	struct dir_bucket b;
+	size_t bucket = hash_string (e->name) % h->bucket_cnt;
+
+	for (size_t i = 0; i < h->bucket_cnt; i++) {
+		off_t ofs = bucket_ofs (bucket);
+		if (inode_read_at (dir->inode, &b, sizeof b, ofs) != sizeof b)
+			return false;
+		for (size_t j = 0; j < BUCKET_SLOTS; j++) {
+			struct dir_entry *slot = &b.slots[j];
+			if (slot->in_use)
+				continue;
+			if (slot->name[0] == '\0')
+				h->used_cnt++;
+			h->live_cnt++;
+			return inode_write_at (dir->inode, e, sizeof *e,
+					ofs + j * sizeof *e) == sizeof *e;
+		}
+		bucket = (bucket + 1) % h->bucket_cnt;
+	}
+	return false;
+}
+
+/* Spreads the entries of DIR over BUCKET_CNT empty buckets, dropping
+ * removed slots. Updates and writes the header H. */
+static bool
+rehash (struct dir *dir, struct dir_header *h, size_t bucket_cnt) {
+	static char zeros[DISK_SECTOR_SIZE];
+	struct dir_bucket b;
+	struct dir_entry *live;
+	size_t live_cnt = 0;
+	bool success = false;
+
+	live = malloc ((h->live_cnt + 1) * sizeof *live);
+	if (live == NULL)
+		return false;
+	for (size_t i = 0; i < h->bucket_cnt; i++) {
+		if (inode_read_at (dir->inode, &b, sizeof b, bucket_ofs (i)) != sizeof b)
+			goto done;
+		for (size_t j = 0; j < BUCKET_SLOTS && live_cnt <= h->live_cnt; j++)
+			if (b.slots[j].in_use)
+				live[live_cnt++] = b.slots[j];
+	}
+
+	for (size_t i = 0; i < bucket_cnt; i++)
+		if (inode_write_at (dir->inode, zeros, DISK_SECTOR_SIZE,
+					bucket_ofs (i)) != DISK_SECTOR_SIZE)
+			goto done;
+	h->bucket_cnt = bucket_cnt;
+	h->used_cnt = h->live_cnt = 0;
+	for (size_t i = 0; i < live_cnt; i++)
+		if (!hashed_insert (dir, h, &live[i]))
+			goto done;
+	success = write_header (dir, h);
+
+done:
+	free (live);
+	return success;
+}
@@ -3,6 +3,7 @@
 #include "filesys/filesys.h"
 #include "threads/malloc.h"
 #include "threads/synch.h"
+#include <bitmap.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -22,14 +23,18 @@ struct fat_fs {	// fat 파일시스템 정보를 담고 있는 구조체
 	unsigned int *fat;		// calloc으로 fat_length 크기만큼 할당받은 fat 배열의 주소
 	unsigned int fat_length;
 	disk_sector_t data_start;
-	cluster_t last_clst;
+	cluster_t last_clst;	// 다음 할당을 찾기 시작할 cluster (next-fit)
 	struct lock write_lock;
+	struct bitmap *used_map;	// cluster별 사용 여부, true면 사용 중이거나 쓸 수 없음
+	unsigned int clst_cnt;		// data 영역에 실제로 있는 cluster 수
 };
 
 static struct fat_fs *fat_fs;
 
 void fat_boot_create (void);
 void fat_fs_init (void);
+static void used_map_build (void);
+static cluster_t alloc_run (cluster_t near, size_t cnt);
 
 void
 fat_init (void) {
@@ -49,6 +54,7 @@ fat_init (void) {
 	if (fat_fs->bs.magic != FAT_MAGIC)
 		fat_boot_create ();
 	fat_fs_init ();
+	lock_init (&fat_fs->write_lock);
 }
 
 void
@@ -78,6 +84,7 @@ fat_open (void) {
 			free (bounce);
 		}
 	}
+	used_map_build ();
 }
 
 void
@@ -126,6 +133,7 @@ fat_create (void) {
 
 	// Set up ROOT_DIR_CLST
 	fat_put (ROOT_DIR_CLUSTER, EOChain);
+	used_map_build ();
 
 	// Fill up ROOT_DIR_CLUSTER region with 0
 	uint8_t *buf = calloc (1, DISK_SECTOR_SIZE);
@@ -165,6 +173,52 @@ fat_fs_init (void) {
 	
 	// 파일이 들어있는 시작 섹터 -> data 저장하는 시작지점
 	fat_fs->data_start = fat_fs->bs.fat_start + fat_fs->bs.fat_sectors;		
+
+	// fat은 sector 단위로 잡혀서 disk 끝을 넘는 cluster까지 가리킬 수 있음
+	unsigned int data_clusters = (fat_fs->bs.total_sectors - fat_fs->data_start) / SECTORS_PER_CLUSTER;
+	fat_fs->clst_cnt = data_clusters < fat_fs->fat_length ? data_clusters : fat_fs->fat_length;
+	fat_fs->last_clst = 2;
+}
+
+/* Rebuilds the map of used clusters from the FAT. Cluster 0 is not a
+ * data cluster and ROOT_DIR_CLUSTER always belongs to the root. */
+static void
+used_map_build (void) {
+	if (fat_fs->used_map != NULL)
+		bitmap_destroy (fat_fs->used_map);
+	fat_fs->used_map = bitmap_create (fat_fs->fat_length);
+	if (fat_fs->used_map == NULL)
+		PANIC ("FAT bitmap creation failed");
+
+	bitmap_set_multiple (fat_fs->used_map, 0, 2, true);
+	for (cluster_t i = 2; i < fat_fs->clst_cnt; i++)
+		if (fat_get (i) != 0)
+			bitmap_mark (fat_fs->used_map, i);
+	bitmap_set_multiple (fat_fs->used_map, fat_fs->clst_cnt,
+			fat_fs->fat_length - fat_fs->clst_cnt, true);
+}
+
+/* Takes CNT free clusters in a row and returns the first, or 0 if
+ * there is no such run. The clusters right after NEAR are preferred so
+ * that a growing file stays contiguous; otherwise the search goes on
+ * from where the last one ended (next-fit) and wraps around once. */
+static cluster_t
+alloc_run (cluster_t near, size_t cnt) {
+	struct bitmap *map = fat_fs->used_map;
+	size_t clst = BITMAP_ERROR;
+
+	if (near != 0 && near + 1 + cnt <= fat_fs->fat_length
+			&& bitmap_none (map, near + 1, cnt))
+		clst = near + 1;
+	if (clst == BITMAP_ERROR)
+		clst = bitmap_scan (map, fat_fs->last_clst, cnt, false);
+	if (clst == BITMAP_ERROR)
+		clst = bitmap_scan (map, 0, cnt, false);
+	if (clst == BITMAP_ERROR)
+		return 0;
+	bitmap_set_multiple (map, clst, cnt, true);
+	fat_fs->last_clst = clst + cnt < fat_fs->fat_length ? clst + cnt : 2;
+	return clst;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -180,38 +234,60 @@ fat_create_chain (cluster_t clst) {
 	// clst(클러스터 인덱싱 번호)로 특정된 클러스터의 뒤에 클러스터를 추가하여 체인을 확장함
 	// 새로 할당된 클러스터의 번호를 반환합니다.
 
-	// clst가 0이면, 새 체인을 만든다 
-	if (clst == 0) {
-		// fat에서 값이 0인(빈) 클러스터를 찾아서 새로 체인을 만든다.
-		for (cluster_t i = 2; i<fat_fs->fat_length; i++) {// i는 2부터 fat_length만큼 
-			if (fat_get(i) == 0) {	
-				fat_put(i, EOChain);
-				return i;
-			}
+	// 빈 cluster는 used_map에서 찾고, 체인을 늘릴 때는 바로 뒤 cluster를 먼저 본다
+	cluster_t new_clst = 0;
+	lock_acquire (&fat_fs->write_lock);
+	// clst가 0이 아니면 clst 클러스터는 항상 마지막 클러스터이어야 함
+	if (clst == 0 || fat_get (clst) == EOChain) {
+		new_clst = alloc_run (clst, 1);
+		if (new_clst != 0) {
+			fat_put (new_clst, EOChain);
+			if (clst != 0)
+				fat_put (clst, new_clst);	// clst 클러스터 뒤에 클러스터를 추가
 		}
 	}
+	lock_release (&fat_fs->write_lock);
+	return new_clst;	// 새로 할당된 클러스터의 번호를 반환
+}
 
-	// clst가 0이 아니면, clst 클러스터 뒤에 클러스터를 추가한다. 
-	else {		
-		// clst 클러스터는 항상 마지막 클러스터이어야 함
-		cluster_t next_clst_idx = fat_get(clst);	
-		if (next_clst_idx != EOChain) {	
-			return 0;
-		}
+/* Extends the chain ending at CLST by CNT clusters, or creates a new
+ * chain of CNT clusters if CLST is 0, and returns the first new
+ * cluster. The clusters come from one contiguous run when the disk has
+ * one. Returns 0 and allocates nothing if there are not CNT free
+ * clusters. */
+cluster_t
+fat_create_run (cluster_t clst, size_t cnt) {
+	cluster_t first = 0;
+
+	ASSERT (cnt > 0);
+
+	lock_acquire (&fat_fs->write_lock);
+	if (clst != 0 && fat_get (clst) != EOChain)
+		goto done;
 
-		// 빈 클러스터 찾기
-		cluster_t new_clst; 
-		for (cluster_t i = 2; i<fat_fs->fat_length; i++) {
-			if (fat_get(i) == 0) {	
-				new_clst = i;
-				break;
-			}
+	first = alloc_run (clst, cnt);
+	if (first != 0) {
+		for (size_t i = 0; i + 1 < cnt; i++)
+			fat_put (first + i, first + i + 1);
+		fat_put (first + cnt - 1, EOChain);
+	} else if (bitmap_count (fat_fs->used_map, 0, fat_fs->fat_length, false) >= cnt) {
+		// 한 번에 이어진 자리가 없으면 흩어진 cluster를 하나씩 모은다
+		cluster_t prev = 0;
+		for (size_t i = 0; i < cnt; i++) {
+			cluster_t c = alloc_run (prev, 1);
+			if (prev == 0)
+				first = c;
+			else
+				fat_put (prev, c);
+			prev = c;
 		}
-		// clst 클러스터 뒤에 클러스터를 추가
-		fat_put(clst, new_clst);
-		fat_put(new_clst, EOChain);
-		return new_clst;	// 새로 할당된 클러스터의 번호를 반환
+		fat_put (prev, EOChain);
 	}
+	if (first != 0 && clst != 0)
+		fat_put (clst, first);
+done:
+	lock_release (&fat_fs->write_lock);
+	return first;
 }
 
 /* Remove the chain of clusters starting from CLST.
@@ -224,9 +300,11 @@ fat_remove_chain (cluster_t clst, cluster_t pclst) {
 	// 즉, 이 함수가 실행된 후에,pclst는 업데이트된 체인의 마지막 요소가 될 것입니다. 
 	// 만약 clst가 체인의 첫 요소라면, pclst는 0이 되어야 합니다.
 	
+	lock_acquire (&fat_fs->write_lock);
 	if(pclst != 0) {	// clst가 체인의 첫 요소가 아니라면 if문 진입
 		// pclst는 체인에서 clst의 바로 이전 클러스터여야 함
 		if(fat_get(pclst) != clst) {
+			lock_release (&fat_fs->write_lock);
 			return;
 		}
 		// pclst가 체인의 마지막 요소가 되어야 함
@@ -238,9 +316,11 @@ fat_remove_chain (cluster_t clst, cluster_t pclst) {
 	while(true) {	
 		next_clst = fat_get(clst);
 		fat_put(clst, 0);					// clst의 val을 0으로 바꾼다. 
+		bitmap_reset (fat_fs->used_map, clst);
 		if (next_clst == EOChain) break;	// 마지막 클러스터이라면 break
 		clst = next_clst;
 	}	
+	lock_release (&fat_fs->write_lock);
 }
 
 /* Update a value in the FAT table. */
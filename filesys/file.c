@@ -122,6 +122,15 @@ off_t file_write_at(struct file *file, const void *buffer, off_t size,
 	return inode_write_at(file->inode, buffer, size, file_ofs);
 }
 
+/* Reserves disk space for the LEN bytes of FILE starting at OFFSET,
+ * growing the file with zeros if it is shorter. Returns true if
+ * successful. The file's current position is unaffected. */
+/* 크기를 미리 아는 writer가 이어진 cluster를 한 번에 받도록 함 */
+bool file_allocate(struct file *file, off_t offset, off_t len){
+	ASSERT(file != NULL);
+	return inode_allocate(file->inode, offset, len);
+}
+
 /* Prevents write operations on FILE's underlying inode
  * until file_allow_write() is called or FILE is closed. */
 /* file_allow_write()를 호출하거나 FILE을 닫을 때까지 
@@ -8,6 +8,9 @@
 #include "filesys/directory.h"
 #include "devices/disk.h"
 #include "filesys/fat.h"
+#include "filesys/buffer_cache.h"
+#include "filesys/dcache.h"
+#include "filesys/page_cache.h"
 #include "threads/thread.h"
 
 /* The disk that contains the file system. */
@@ -24,7 +27,9 @@ void filesys_init(bool format)
 	if (filesys_disk == NULL)
 		PANIC("hd0:1 (hdb) not present, file system initialization failed");
 
+	buffer_cache_init();
 	inode_init();
+	dcache_init();
 
 #ifdef EFILESYS
 	fat_init();
@@ -53,12 +58,18 @@ void filesys_init(bool format)
  * to disk. */
 void filesys_done(void)
 {
+#ifdef VM
+	page_cache_flush();
+#endif
+
 	/* Original FS */
 #ifdef EFILESYS
 	fat_close();
 #else
 	free_map_close();
 #endif
+	// FAT과 free map을 닫으면서 쓴 sector까지 disk에 내려야 하므로 맨 마지막에 한다
+	buffer_cache_flush();
 }
 
 /* Creates a file named NAME with the given INITIAL_SIZE.
@@ -1,4 +1,5 @@
 #include "filesys/inode.h"
+#include <hash.h>
 #include <list.h>
 #include <debug.h>
 #include <round.h>
@@ -7,10 +8,20 @@
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
 #include "filesys/fat.h"
+#include "filesys/buffer_cache.h"
+#ifdef VM
+#include "filesys/page_cache.h"
+#endif
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
 
+/* Number of closed inodes kept in memory for a quick reopen. */
+#define INODE_LRU_SIZE 32
+
+/* Largest number of clusters reserved at once when a file grows. */
+#define PREALLOC_MAX 64
+
 /* On-disk inode.
  * Must be exactly DISK_SECTOR_SIZE bytes long. */
 struct inode_disk
@@ -42,23 +53,120 @@ bytes_to_sectors(off_t size)
 /* In-memory inode. */
 struct inode
 {
-	struct list_elem elem;	/* Element in inode list. */
+	struct hash_elem elem;	/* Element in inode table. */
+	struct list_elem lru_elem; /* 닫힌 뒤 closed_inodes에 있을 때의 element */
 	disk_sector_t sector;	/* Sector number of disk location. */ // 디스크에서 몇번째 섹터인지(숫자임)
 	int open_cnt;			/* Number of openers. */
 	bool removed;			/* True if deleted, false otherwise. */
+	bool is_dir;			/* data.is_dir, open할 때 읽어둠 */
 	int deny_write_cnt;		/* 0: writes ok, >0: deny writes. */
+	off_t next_read;		/* 직전 read가 끝난 위치, 여기서 이어 읽으면 순차 read */
+	cluster_t *clusters;	/* 지금까지 따라간 cluster chain, i번째 sector의 cluster */
+	size_t clst_cnt;		/* clusters에 채운 수 */
+	size_t clst_cap;		/* clusters의 크기 */
+	size_t prealloc_window; /* 다음에 파일이 커질 때 한 번에 잡을 cluster 수 */
+	bool preallocated;		/* 길이보다 많이 잡아둔 cluster가 있을 수 있음 */
 	//  디스크에 저장된 메타데이터 정보를 물리메모리에 올려놓은 것이다.
 	// 매번 disk에 참조할 수 없기 때문에 물리 메모리에 올려놓고 사용하며,
 	// 더이상 필요가 없어지면 inode_close()시에 다시 disk에 write back한다.
 	struct inode_disk data; /* Inode content. */
 };
 
+/* Returns the cluster after CLST in its chain, adding one to the chain
+ * if CLST is the last. */
+static cluster_t
+chain_next(cluster_t clst)
+{
+	///// file grow
+	if (fat_get(clst) == EOChain)
+	{						  // clst가 마지막 cluster이면
+		fat_create_chain(clst); // 체인 하나 추가
+	}
+	//// file grow
+	return fat_get(clst); // 다음 cluster 받기
+}
+
+/* Follows the chain CNT clusters on from CLST. Used only when the
+ * cluster cache cannot grow. */
+static cluster_t
+chain_walk(cluster_t clst, size_t cnt)
+{
+	while (cnt-- > 0)
+		clst = chain_next(clst);
+	return clst;
+}
+
+/* Appends CLST to INODE's cluster cache. Returns false if out of
+ * memory. */
+static bool
+cluster_cache_push(struct inode *inode, cluster_t clst)
+{
+	if (inode->clst_cnt == inode->clst_cap)
+	{
+		size_t cap = inode->clst_cap ? inode->clst_cap * 2 : 16;
+		cluster_t *clusters = realloc(inode->clusters, cap * sizeof *clusters);
+		if (clusters == NULL)
+			return false;
+		inode->clusters = clusters;
+		inode->clst_cap = cap;
+	}
+	inode->clusters[inode->clst_cnt++] = clst;
+	return true;
+}
+
+/* Extends INODE's chain after TAIL by at least NEED clusters and
+ * returns the first new one, or 0 if the disk is full. Each growth takes
+ * a window of clusters in one run; the window doubles every time the
+ * file grows again and halves when no run that long is free. Clusters
+ * left unused are trimmed in inode_close(). */
+static cluster_t
+inode_grow(struct inode *inode, cluster_t tail, size_t need)
+{
+	size_t cnt = need > inode->prealloc_window ? need : inode->prealloc_window;
+	cluster_t first = fat_create_run(tail, cnt);
+
+	if (first == 0 && cnt > need)
+	{ // window만큼은 없으면 필요한 만큼만
+		inode->prealloc_window = inode->prealloc_window / 2 > 0 ? inode->prealloc_window / 2 : 1;
+		return fat_create_run(tail, need);
+	}
+	if (first != 0)
+	{
+		if (cnt > need)
+			inode->preallocated = true;
+		if (inode->prealloc_window * 2 <= PREALLOC_MAX)
+			inode->prealloc_window *= 2;
+	}
+	return first;
+}
+
+/* Gives back the clusters INODE reserved past the end of its data. */
+static void
+inode_trim(struct inode *inode)
+{
+	size_t keep = bytes_to_sectors(inode->data.length);
+	if (keep == 0)
+		keep = 1; // 빈 파일도 cluster 하나는 가지고 있다
+	if (inode->clst_cnt == 0)
+		return;
+
+	size_t idx = keep < inode->clst_cnt ? keep : inode->clst_cnt;
+	cluster_t last = inode->clusters[idx - 1];
+	for (; idx < keep && fat_get(last) != EOChain; idx++)
+		last = fat_get(last);
+	if (fat_get(last) != EOChain)
+		fat_remove_chain(fat_get(last), last);
+	if (inode->clst_cnt > keep)
+		inode->clst_cnt = keep;
+	inode->preallocated = false;
+}
+
 /* Returns the disk sector that contains byte offset POS within
  * INODE.
  * Returns -1 if INODE does not contain data for a byte at offset
  * POS. */
 static disk_sector_t
-byte_to_sector(const struct inode *inode, off_t pos)
+byte_to_sector(struct inode *inode, off_t pos)
 {
 	ASSERT(inode != NULL);
 	// 기존에는 그냥 다음 sector를 찾아가게 만들었음
@@ -72,35 +180,72 @@ byte_to_sector(const struct inode *inode, off_t pos)
 	//------project4-start-----------------------
 
 	// fat을 보고 inode 찾아가게 만들기
-	// if (pos < inode->data.length) {
-	cluster_t start_clust = sector_to_cluster(inode->data.start); // start의 cluster index 받기
-	while (pos >= DISK_SECTOR_SIZE)
-	{ // pos가 속한 cluster 찾기
-		///// file grow
-		if (fat_get(start_clust) == EOChain)
-		{								   // start_clust가 마지막 cluster이면
-			fat_create_chain(start_clust); // 체인 하나 추가
-		}
-		//// file grow
-		start_clust = fat_get(start_clust); // 다음 cluster 받기
-		pos -= DISK_SECTOR_SIZE;
+	// 한 번 따라간 cluster는 inode->clusters에 남겨두고 그 뒤만 fat을 따라가므로
+	// 순차/random read 모두 sector당 O(1)이다
+	size_t idx = pos / DISK_SECTOR_SIZE;
+	if (inode->clst_cnt == 0 && !cluster_cache_push(inode, sector_to_cluster(inode->data.start)))
+		return cluster_to_sector(chain_walk(sector_to_cluster(inode->data.start), idx));
+	while (inode->clst_cnt <= idx)
+	{ // pos가 속한 cluster까지 chain을 따라가며 기억
+		cluster_t tail = inode->clusters[inode->clst_cnt - 1];
+		cluster_t next = fat_get(tail);
+		if (next == EOChain) // 파일이 커짐, pos까지 필요한 cluster를 한 번에 잡는다
+			next = inode_grow(inode, tail, idx + 1 - inode->clst_cnt);
+		if (next == 0)
+			return -1;
+		if (!cluster_cache_push(inode, next))
+			return cluster_to_sector(chain_walk(next, idx - inode->clst_cnt));
 	}
-	return cluster_to_sector(start_clust);
+	return cluster_to_sector(inode->clusters[idx]);
 	// }
 	// else
 	// 	return -1;
 	//------project4-end--------------------------
 }
 
-/* List of open inodes, so that opening a single inode twice
- * returns the same `struct inode'. */
-// in-memory inode 전역변수 (Double linked list)
-static struct list open_inodes;
+/* Table of in-memory inodes keyed by sector, so that opening a single
+ * inode twice returns the same `struct inode'. Besides the open inodes
+ * it holds the last INODE_LRU_SIZE closed ones, which are listed in
+ * closed_inodes from most to least recently closed. Reopening one of
+ * them needs no disk access. */
+// in-memory inode 전역변수 (sector -> inode)
+static struct hash open_inodes;
+static struct list closed_inodes;
+static size_t closed_cnt;
+
+static uint64_t inode_hash(const struct hash_elem *e, void *aux);
+static bool inode_less(const struct hash_elem *a, const struct hash_elem *b,
+					   void *aux);
+static void inode_free(struct inode *inode);
 
 /* Initializes the inode module. */
 void inode_init(void)
 {
-	list_init(&open_inodes);
+	hash_init(&open_inodes, inode_hash, inode_less, NULL);
+	list_init(&closed_inodes);
+}
+
+static uint64_t
+inode_hash(const struct hash_elem *e, void *aux UNUSED)
+{
+	const struct inode *inode = hash_entry(e, struct inode, elem);
+	return hash_int(inode->sector);
+}
+
+static bool
+inode_less(const struct hash_elem *a, const struct hash_elem *b,
+		   void *aux UNUSED)
+{
+	return hash_entry(a, struct inode, elem)->sector < hash_entry(b, struct inode, elem)->sector;
+}
+
+/* Drops INODE from the inode table and frees it. */
+static void
+inode_free(struct inode *inode)
+{
+	hash_delete(&open_inodes, &inode->elem);
+	free(inode->clusters);
+	free(inode);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -133,53 +278,26 @@ bool inode_create(disk_sector_t sector, off_t length, uint32_t is_dir)
 		disk_inode->is_dir = is_dir; // inode 생성 시, 파일,디렉터리 구분을 위한 필드를 is_dir인자 값으로 설정
 
 		//------project4-start--------------------------------------------
-		cluster_t new_cluster = fat_create_chain(0); // 새로운 체인 만들기
+		// 파일 크기만큼의 cluster를 한 번에, 가능하면 이어진 자리로 잡는다 (빈 파일도 1개)
+		cluster_t new_cluster = fat_create_run(0, sectors > 0 ? sectors : 1); // 새로운 체인 만들기
 		if (new_cluster == 0)
 		{ // 체인 만들기에 실패한 경우, 예외처리
 			free(disk_inode);
 			return success;
 		}
 		disk_inode->start = cluster_to_sector(new_cluster); // 새로운 체인을 만든 뒤에 해당 주소를 disk_inode->start값에 넣어주기
-		disk_write(filesys_disk, sector, disk_inode);		// inode의 구조체(메타데이터) disk에 쓰기
-
-		// cluster_t clst = sector_to_cluster(disk_inode->start);
-		// cluster_t next_clst;
-		// // sectors 개수만큼 클러스터 체인을 만들기
-		// for (size_t i=1; i<sectors; i++) {
-		// 	next_clst = fat_create_chain(clst);
-		// 	if(next_clst == 0) {	// 체인 만들기에 실패한 경우 예외처리
-		// 		free(disk_inode);
-		// 		return success;
-		// 	}
-		// 	clst = next_clst;
-		// }
+		buffer_cache_write(sector, disk_inode, 0, DISK_SECTOR_SIZE); // inode의 구조체(메타데이터) disk에 쓰기
 
 		// inode(진짜 데이터들)를 저장하는 클러스터 체인을 모두 0으로 초기화
 		if (sectors > 0)
 		{
-			//////////
-			cluster_t clst = sector_to_cluster(disk_inode->start);
-			cluster_t next_clst;
-			// sectors 개수만큼 클러스터 체인을 만들기
-			for (size_t i = 1; i < sectors; i++)
+			static char zeros[DISK_SECTOR_SIZE];
+			cluster_t clst = new_cluster;
+			for (size_t i = 0; i < sectors; i++)
 			{
-				next_clst = fat_create_chain(clst);
-				if (next_clst == 0)
-				{ // 체인 만들기에 실패한 경우 예외처리
-					free(disk_inode);
-					return success;
-				}
-				clst = next_clst;
+				buffer_cache_write(cluster_to_sector(clst), zeros, 0, DISK_SECTOR_SIZE);
+				clst = fat_get(clst);
 			}
-			//////////
-			static char zeros[DISK_SECTOR_SIZE];
-			size_t i;
-			disk_sector_t old_disk_sector = disk_inode->start;
-			disk_sector_t new_disk_sector;
-			for (i = 0; i < sectors; i++)
-				disk_write(filesys_disk, old_disk_sector, zeros);
-			new_disk_sector = cluster_to_sector(fat_get(sector_to_cluster(old_disk_sector)));
-			old_disk_sector = new_disk_sector;
 		}
 		free(disk_inode); // mem에서 잠깐 사용한 temp buffer 느낌이므로 free해주기
 		success = true;
@@ -210,19 +328,25 @@ bool inode_create(disk_sector_t sector, off_t length, uint32_t is_dir)
 struct inode *
 inode_open(disk_sector_t sector)
 {
-	struct list_elem *e;
+	struct inode key;
+	struct hash_elem *e;
 	struct inode *inode;
 
 	/* Check whether this inode is already open. */
-	for (e = list_begin(&open_inodes); e != list_end(&open_inodes);
-		 e = list_next(e))
+	key.sector = sector;
+	e = hash_find(&open_inodes, &key.elem);
+	if (e != NULL)
 	{
-		inode = list_entry(e, struct inode, elem);
-		if (inode->sector == sector)
-		{
-			inode_reopen(inode);
-			return inode;
+		inode = hash_entry(e, struct inode, elem);
+		if (inode->open_cnt == 0)
+		{ // 최근에 닫힌 inode, disk에서 다시 읽을 필요 없음
+			list_remove(&inode->lru_elem);
+			closed_cnt--;
+			inode->next_read = 0;
+			inode->prealloc_window = 1;
 		}
+		inode_reopen(inode);
+		return inode;
 	}
 
 	/* Allocate memory. */
@@ -231,12 +355,18 @@ inode_open(disk_sector_t sector)
 		return NULL;
 
 	/* Initialize. */
-	list_push_front(&open_inodes, &inode->elem);
 	inode->sector = sector;
+	hash_insert(&open_inodes, &inode->elem);
 	inode->open_cnt = 1;
 	inode->deny_write_cnt = 0;
 	inode->removed = false; // 삭제되면 true로 바꿈
-	disk_read(filesys_disk, inode->sector, &inode->data);
+	inode->next_read = 0;
+	inode->clusters = NULL;
+	inode->clst_cnt = inode->clst_cap = 0;
+	inode->prealloc_window = 1;
+	inode->preallocated = false;
+	buffer_cache_read(inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+	inode->is_dir = inode->data.is_dir != 0;
 	return inode;
 }
 
@@ -265,21 +395,35 @@ void inode_close(struct inode *inode)
 	if (inode == NULL)
 		return;
 
+#ifdef VM
+	// 지워진 파일을 page cache만 열어두고 있게 되면 cached page를 같이 내린다
+	if (inode->removed)
+		inode->open_cnt -= page_cache_forget(inode, inode->open_cnt - 1);
+#endif
+
 	/* Release resources if this was the last opener. */
 	if (--inode->open_cnt == 0)
 	{ // open_cnt가 0일 경우에만 inode를 삭제해준다.
-		/* Remove from inode list and release lock. */
-		list_remove(&inode->elem);
-
 		//------project4-start------------------------
 		if (inode->removed)
 		{
 			fat_remove_chain(sector_to_cluster(inode->sector), 0);	   // inode 구조체(메타데이터) fat에서 제거
 			fat_remove_chain(sector_to_cluster(inode->data.start), 0); // inode 실제 데이터들 모두를 fat에서 제거
+			inode_free(inode);
+			return;
 		}
+		if (inode->preallocated)
+			inode_trim(inode); // 쓰지 않은 preallocation은 돌려준다
 		// 기존 파일 크기보다 더 크게 write를 한 경우, disk에 업데이트 해 주어야 함
-		disk_write(filesys_disk, inode->sector, &inode->data);
-		free(inode);
+		buffer_cache_write(inode->sector, &inode->data, 0, DISK_SECTOR_SIZE);
+
+		// 바로 free하지 않고 closed_inodes에 남겨뒀다가 가장 오래된 것부터 free
+		list_push_front(&closed_inodes, &inode->lru_elem);
+		if (++closed_cnt > INODE_LRU_SIZE)
+		{
+			inode_free(list_entry(list_pop_back(&closed_inodes), struct inode, lru_elem));
+			closed_cnt--;
+		}
 		//------project4-end--------------------------
 
 		//////// 기존 코드 start
@@ -308,11 +452,10 @@ off_t inode_read_at(struct inode *inode, void *buffer_, off_t size, off_t offset
 {
 	uint8_t *buffer = buffer_;
 	off_t bytes_read = 0;
-	uint8_t *bounce = NULL;
+	bool sequential = offset == inode->next_read;
 	while (size > 0)
 	{
-		/* Disk sector to read, starting byte offset within sector. */
-		disk_sector_t sector_idx = byte_to_sector(inode, offset);
+		/* Starting byte offset within sector. */
 		int sector_ofs = offset % DISK_SECTOR_SIZE;
 
 		/* Bytes left in inode, bytes left in sector, lesser of the two. */
@@ -325,31 +468,21 @@ off_t inode_read_at(struct inode *inode, void *buffer_, off_t size, off_t offset
 		if (chunk_size <= 0)
 			break;
 
-		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE)
-		{
-			/* Read full sector directly into caller's buffer. */
-			disk_read(filesys_disk, sector_idx, buffer + bytes_read);
-		}
-		else
-		{
-			/* Read sector into bounce buffer, then partially copy
-			 * into caller's buffer. */
-			if (bounce == NULL)
-			{
-				bounce = malloc(DISK_SECTOR_SIZE);
-				if (bounce == NULL)
-					break;
-			}
-			disk_read(filesys_disk, sector_idx, bounce);
-			memcpy(buffer + bytes_read, bounce + sector_ofs, chunk_size);
-		}
+		// EOF를 먼저 확인해야 byte_to_sector()가 file을 늘리지 않는다
+		disk_sector_t sector_idx = byte_to_sector(inode, offset);
+		buffer_cache_read(sector_idx, buffer + bytes_read, sector_ofs, chunk_size);
 
 		/* Advance. */
 		size -= chunk_size;
 		offset += chunk_size;
 		bytes_read += chunk_size;
 	}
-	free(bounce);
+
+	// 이어서 읽고 있으면 다음 sector를 미리 읽어 둔다
+	off_t next = ROUND_UP(offset, DISK_SECTOR_SIZE);
+	if (sequential && bytes_read > 0 && next < inode_length(inode))
+		buffer_cache_readahead(byte_to_sector(inode, next));
+	inode->next_read = offset;
 	return bytes_read;
 }
 
@@ -363,15 +496,18 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size,
 {
 	const uint8_t *buffer = buffer_;
 	off_t bytes_written = 0;
-	uint8_t *bounce = NULL;
 
 	if (inode->deny_write_cnt)
 		return 0;
 
-	// 만약 write를 통해서 file의 크기가 늘어나야 한다면, offset+size만큼 file의 크기 늘려주기
-	if (offset + size > inode->data.length)
+	// write를 통해서 file이 커진다면 offset+size까지 쓸 수 있게 한다
+	// data.length는 실제로 쓴 만큼만 아래에서 늘린다
+	off_t length = inode_length(inode);
+	if (offset + size > length)
 	{
-		inode->data.length = offset + size;
+		length = offset + size;
+		// 마지막 byte부터 찾으면 늘어날 cluster를 한 번의 run으로 잡는다
+		byte_to_sector(inode, offset + size - 1);
 	}
 
 	while (size > 0)
@@ -379,9 +515,11 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size,
 		/* Sector to write, starting byte offset within sector. */
 		disk_sector_t sector_idx = byte_to_sector(inode, offset);
 		int sector_ofs = offset % DISK_SECTOR_SIZE;
+		if (sector_idx == (disk_sector_t)-1)
+			break; // disk가 가득 참
 
 		/* Bytes left in inode, bytes left in sector, lesser of the two. */
-		off_t inode_left = inode_length(inode) - offset;
+		off_t inode_left = length - offset;
 		int sector_left = DISK_SECTOR_SIZE - sector_ofs;
 		int min_left = inode_left < sector_left ? inode_left : sector_left; // file의 크기보다 더 크게 쓸 수 있도록 해야 함
 
@@ -390,42 +528,50 @@ off_t inode_write_at(struct inode *inode, const void *buffer_, off_t size,
 		if (chunk_size <= 0)
 			break;
 
-		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE)
-		{
-			/* Write full sector directly to disk. */
-			disk_write(filesys_disk, sector_idx, buffer + bytes_written);
-		}
-		else
-		{
-			/* We need a bounce buffer. */
-			if (bounce == NULL)
-			{
-				bounce = malloc(DISK_SECTOR_SIZE);
-				if (bounce == NULL)
-					break;
-			}
-
-			/* If the sector contains data before or after the chunk
-			   we're writing, then we need to read in the sector
-			   first.  Otherwise we start with a sector of all zeros. */
-			if (sector_ofs > 0 || chunk_size < sector_left)
-				disk_read(filesys_disk, sector_idx, bounce);
-			else
-				memset(bounce, 0, DISK_SECTOR_SIZE);
-			memcpy(bounce + sector_ofs, buffer + bytes_written, chunk_size);
-			disk_write(filesys_disk, sector_idx, bounce);
-		}
+		buffer_cache_write(sector_idx, buffer + bytes_written, sector_ofs, chunk_size);
 
 		/* Advance. */
 		size -= chunk_size;
 		offset += chunk_size;
 		bytes_written += chunk_size;
 	}
-	free(bounce);
 
+	// disk가 가득 차 중간에 멈췄어도 길이는 cluster가 있는 곳까지만
+	if (offset > inode->data.length)
+		inode->data.length = offset;
 	return bytes_written;
 }
 
+/* Makes sure that the LEN bytes of INODE starting at OFFSET are backed
+ * by clusters, extending the file with zeros if it ends before
+ * OFFSET + LEN. New clusters come from one run when the disk has one.
+ * Returns false if the range is invalid or the disk is full. */
+bool inode_allocate(struct inode *inode, off_t offset, off_t len)
+{
+	static char zeros[DISK_SECTOR_SIZE];
+
+	if (offset < 0 || len <= 0 || offset > INT32_MAX - len || inode->deny_write_cnt)
+		return false;
+
+	off_t end = offset + len;
+	off_t pos = inode->data.length;
+	if (end <= pos)
+		return true;
+	if (byte_to_sector(inode, end - 1) == (disk_sector_t)-1)
+		return false;
+
+	// 늘어난 부분은 0으로 읽혀야 한다
+	while (pos < end)
+	{
+		int sector_ofs = pos % DISK_SECTOR_SIZE;
+		buffer_cache_write(byte_to_sector(inode, pos), zeros, sector_ofs,
+						   DISK_SECTOR_SIZE - sector_ofs);
+		pos += DISK_SECTOR_SIZE - sector_ofs;
+	}
+	inode->data.length = end;
+	return true;
+}
+
 /* Disables writes to INODE.
    May be called at most once per inode opener. */
 void inode_deny_write(struct inode *inode)
@@ -456,17 +602,8 @@ off_t inode_length(const struct inode *inode)
 // fd의 in-memory inode가 디렉터리 인지 판단하여 성공여부 반환
 bool inode_is_dir(const struct inode *inode)
 {
-	bool result;
-	/* inode_disk 자료구조를 메모리에 할당 */
-	struct inode_disk *disk_inode = calloc(1, sizeof *disk_inode);
-
-	/* in-memory inode의 on-disk inode를 읽어 inode_disk에 저장 */
-	disk_read(filesys_disk, cluster_to_sector(inode->sector), disk_inode);
-
-	/* on-disk inode의 is_dir을 result에 저장하여 반환 */
-	result = disk_inode->is_dir; // 1 or 0이 있을거임.
-
-	return result;
+	// 파일 종류는 바뀌지 않으므로 inode_open()에서 읽어둔 값을 쓴다
+	return inode != NULL && inode->is_dir;
 }
 
 //------project4-end-----------------------------------------------------
@@ -1,9 +1,30 @@
-/* page_cache.c: Implementation of Page Cache (Buffer Cache). */
+/* page_cache.c: Implementation of Page Cache (Buffer Cache).
+ *
+ * 파일 내용을 page 크기의 frame에 두고 (inode, offset)으로 찾는다.
+ * read()/write()와 mmap fault가 모두 같은 page를 쓰기 때문에 파일을 읽는
+ * 프로세스와 매핑한 프로세스가 항상 같은 내용을 본다. page cache의 frame도
+ * frame table에 들어 있어서 eviction 정책이 anonymous page와 같은 기준으로
+ * 고르고, 매핑을 통해 수정된 page는 writeback worker가 주기적으로 파일에 쓴다.
+ * write()는 sector cache까지 바로 쓰고 cache에 있는 page만 고친다. */
 
+#include "filesys/page_cache.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
 #include "vm/vm.h"
+#include "vm/faultstat.h"
+
+#ifdef VM
 static bool page_cache_readahead (struct page *page, void *kva);
 static bool page_cache_writeback (struct page *page);
 static void page_cache_destroy (struct page *page);
+static void page_cache_kworkerd (void *aux);
 
 /* DO NOT MODIFY this struct */
 static const struct page_operations page_cache_op = {
@@ -15,36 +36,430 @@ static const struct page_operations page_cache_op = {
 
 tid_t page_cache_workerd;
 
+/* (inode, offset) -> page. 찾고 넣는 것은 모두 VM lock을 잡고 한다. */
+static struct hash page_cache;
+
+/* Statistics. */
+static long long hit_cnt;		/* cache에 있던 횟수 */
+static long long miss_cnt;		/* 파일에서 새로 읽은 page 수 */
+static long long writeback_cnt;	/* 파일에 write back한 page 수 */
+static long long drop_cnt;		/* evict된 page 수 */
+
+/* 파일 내용이 바뀔 때마다 (write(), write back) 올린다. VM lock 없이 파일에서
+ * 읽어둔 page가 그 사이 낡았는지 page_cache_get()이 확인한다. */
+static unsigned write_seq;
+
+static struct page *lookup (struct inode *inode, off_t offset);
+static off_t page_bytes (struct inode *inode, off_t offset);
+static uint64_t page_cache_hash (const struct hash_elem *e, void *aux);
+static bool page_cache_less (const struct hash_elem *a,
+		const struct hash_elem *b, void *aux);
+
+/* Sets up the page cache index and starts the writeback worker. */
+void
+page_cache_init (void) {
+	hash_init (&page_cache, page_cache_hash, page_cache_less, NULL);
+	page_cache_workerd = thread_create ("pc_writeback", PRI_DEFAULT,
+			page_cache_kworkerd, NULL);
+}
+
 /* The initializer of file vm */
 void
 pagecache_init (void) {
-	/* TODO: Create a worker daemon for page cache with page_cache_kworkerd */
+	page_cache_init ();
 }
 
 /* Initialize the page cache */
 bool
-page_cache_initializer (struct page *page, enum vm_type type, void *kva) {
+page_cache_initializer (struct page *page, enum vm_type type UNUSED,
+		void *kva UNUSED) {
 	/* Set up the handler */
 	page->operations = &page_cache_op;
+	return true;
+}
 
+/* Returns the page holding the page of INODE at OFFSET, a multiple of
+ * PGSIZE, loading it from the file if it is not cached. A frame is only
+ * evicted for it if EVICT is true. Such callers only touch their own
+ * pages, so the VM lock is dropped while the file is read and other
+ * faults go on during the disk I/O; the prefetch thread passes false and
+ * keeps it. Returns a null pointer on failure. Must be called with the
+ * VM lock held. */
+struct page *
+page_cache_get (struct inode *inode, off_t offset, bool evict) {
+	struct page *page = lookup (inode, offset);
+
+	ASSERT (offset % PGSIZE == 0);
+
+	if (page != NULL) {
+		hit_cnt++;
+		return page;
+	}
+
+	struct frame *frame = evict ? vm_get_frame () : vm_try_get_frame ();
+	if (frame == NULL)
+		return NULL;
+	page = malloc (sizeof *page);
+	if (page == NULL) {
+		vm_frame_free (frame);
+		return NULL;
+	}
+	page_cache_initializer (page, VM_PAGE_CACHE, frame->kva);
+	page->va = NULL;
+	page->owner = NULL;		// 어느 프로세스의 것도 아님
+	page->writable = false;
+
+	// 매핑 길이와 상관없이 이 page에 들어 있는 파일 내용을 전부 올려둔다
+	struct page_cache *pc = &page->page_cache;
+	pc->inode = inode;
+	pc->offset = offset;
+	pc->bytes = page_bytes (inode, offset);
+	pc->dirty = false;
+	pc->referenced = false;
+	list_init (&pc->mappers);
+
+	// frame->page가 아직 NULL이라 lock을 놓은 사이 evict되지 않는다
+	bool ok = false;
+	if (evict) {
+		unsigned seq = write_seq;
+		vm_lock_release (true);
+		ok = swap_in (page, frame->kva);
+		vm_lock_acquire ();
+		ok = ok && seq == write_seq;
+	}
+	if (!ok) {
+		// 읽는 사이 파일이 바뀌었으면 lock을 잡은 채로 다시 읽는다
+		pc->bytes = page_bytes (inode, offset);
+		if (!swap_in (page, frame->kva)) {
+			free (page);
+			vm_frame_free (frame);
+			return NULL;
+		}
+	}
+	faultstat_note (FAULT_FILE);
+
+	pc->inode = inode_reopen (inode);
+	page->frame = frame;
+	vm_frame_set_page (frame, page);
+	struct hash_elem *old = hash_insert (&page_cache, &pc->elem);
+	if (old != NULL) {
+		// 읽는 사이 같은 page가 올라왔으면 그것을 쓴다
+		inode_close (pc->inode);
+		vm_frame_free (frame);
+		free (page);
+		hit_cnt++;
+		return hash_entry (old, struct page, page_cache.elem);
+	}
+	miss_cnt++;
+	return page;
+}
+
+/* Writes PAGE back to its file if a mapper has modified it. */
+void
+page_cache_sync (struct page *page) {
+	page_cache_writeback (page);
+}
+
+/* Writes back every page modified through a mapping. */
+void
+page_cache_flush (void) {
+	bool locked = vm_lock_acquire ();
+	struct hash_iterator i;
+
+	hash_first (&i, &page_cache);
+	while (hash_next (&i))
+		page_cache_writeback (hash_entry (hash_cur (&i), struct page,
+					page_cache.elem));
+	vm_lock_release (locked);
+}
+
+/* Reads SIZE bytes at OFFSET of INODE into BUFFER through the cache.
+ * BUFFER may be user memory, so every piece is copied into a bounce page
+ * with the VM lock held and from there into BUFFER without it: a fault
+ * on BUFFER must not evict the page being copied. */
+off_t
+page_cache_read (struct inode *inode, void *buffer_, off_t size,
+		off_t offset) {
+	uint8_t *buffer = buffer_;
+	uint8_t *bounce = palloc_get_page (0);
+	off_t bytes_read = 0;
+
+	if (bounce == NULL)
+		return 0;
+	while (size > 0) {
+		off_t page_ofs = offset % PGSIZE;
+		off_t inode_left = inode_length (inode) - offset;
+		off_t chunk = size < inode_left ? size : inode_left;
+		if (chunk > PGSIZE - page_ofs)
+			chunk = PGSIZE - page_ofs;
+		if (chunk <= 0)
+			break;
+
+		bool locked = vm_lock_acquire ();
+		struct page *page = page_cache_get (inode, offset - page_ofs, true);
+		if (page != NULL) {
+			memcpy (bounce, page->frame->kva + page_ofs, chunk);
+			page->page_cache.referenced = true;
+		}
+		vm_lock_release (locked);
+		// frame을 못 얻었으면 cache 없이 읽는다
+		if (page == NULL && inode_read_at (inode, bounce, chunk, offset) != chunk)
+			break;
+		memcpy (buffer + bytes_read, bounce, chunk);
+
+		size -= chunk;
+		offset += chunk;
+		bytes_read += chunk;
+	}
+	palloc_free_page (bounce);
+	return bytes_read;
+}
+
+/* Writes SIZE bytes from BUFFER at OFFSET of INODE. The data goes to
+ * the file right away and into the cached page, if any, so that readers
+ * and mappers see it. The file is written without the VM lock.
+ * BUFFER may be user memory, see page_cache_read(). */
+off_t
+page_cache_write (struct inode *inode, const void *buffer_, off_t size,
+		off_t offset) {
+	const uint8_t *buffer = buffer_;
+	uint8_t *bounce = palloc_get_page (0);
+	off_t bytes_written = 0;
+
+	if (bounce == NULL)
+		return 0;
+	while (size > 0) {
+		off_t page_ofs = offset % PGSIZE;
+		off_t chunk = size < PGSIZE - page_ofs ? size : PGSIZE - page_ofs;
+		memcpy (bounce, buffer + bytes_written, chunk);
+
+		// 쓰기 전후로 write_seq를 올려서 그 사이 파일에서 읽은 page는 다시 읽힌다
+		bool locked = vm_lock_acquire ();
+		unsigned seq = ++write_seq;
+		vm_lock_release (locked);
+		off_t written = inode_write_at (inode, bounce, chunk, offset);
+		locked = vm_lock_acquire ();
+		bool raced = seq != write_seq;
+		write_seq++;
+		struct page *page = lookup (inode, offset - page_ofs);
+		if (page != NULL && written > 0) {
+			struct page_cache *pc = &page->page_cache;
+			memcpy (page->frame->kva + page_ofs, bounce, written);
+			if (page_ofs + written > pc->bytes)
+				pc->bytes = page_ofs + written;	// write가 파일을 늘렸음
+			pc->referenced = true;
+			// 쓰는 사이 옛 page가 write back되어 방금 쓴 내용을 덮었을 수 있다
+			if (raced)
+				pc->dirty = true;
+		}
+		vm_lock_release (locked);
+
+		size -= written;
+		offset += written;
+		bytes_written += written;
+		if (written < chunk)
+			break;
+	}
+	palloc_free_page (bounce);
+	return bytes_written;
+}
+
+/* Returns true if FRAME, a page cache frame, was read, written or
+ * accessed through a mapping since the last call, and clears that. */
+bool
+page_cache_test_and_clear_accessed (struct frame *frame) {
+	struct page_cache *pc = &frame->page->page_cache;
+	bool accessed = pc->referenced;
+
+	pc->referenced = false;
+	for (struct list_elem *e = list_begin (&pc->mappers);
+			e != list_end (&pc->mappers); e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, file.share_elem);
+		if (pml4_is_accessed (page->owner->pml4, page->va)) {
+			pml4_set_accessed (page->owner->pml4, page->va, false);
+			accessed = true;
+		}
+	}
+	return accessed;
+}
+
+/* Returns true if dropping FRAME, a page cache frame, has to write it
+ * back first. */
+bool
+page_cache_is_dirty (struct frame *frame) {
+	struct page_cache *pc = &frame->page->page_cache;
+
+	if (pc->dirty)
+		return true;
+	for (struct list_elem *e = list_begin (&pc->mappers);
+			e != list_end (&pc->mappers); e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, file.share_elem);
+		if (pml4_is_dirty (page->owner->pml4, page->va))
+			return true;
+	}
+	return false;
+}
+
+/* Evicts the page in FRAME: writes it back if it was modified, unmaps it
+ * from every mapper and forgets it. FRAME stays in the frame table for
+ * the caller to reuse. */
+void
+page_cache_drop (struct frame *frame) {
+	struct page *page = frame->page;
+	struct page_cache *pc = &page->page_cache;
+
+	page_cache_writeback (page);
+	while (!list_empty (&pc->mappers)) {
+		struct page *p = list_entry (list_pop_front (&pc->mappers),
+				struct page, file.share_elem);
+		pml4_clear_page (p->owner->pml4, p->va);
+		p->file.cache = NULL;
+		p->frame = NULL;
+	}
+	vm_frame_set_page (frame, NULL);
+	page->frame = NULL;
+	vm_dealloc_page (page);
+	drop_cnt++;
+}
+
+/* Drops the cached pages of INODE, a removed file, if they hold all
+ * REFS of its other references, so that closing it for the last time
+ * frees its clusters. Returns the number of references dropped. */
+int
+page_cache_forget (struct inode *inode, int refs) {
+	bool locked = vm_lock_acquire ();
+	struct hash_iterator i;
+	int cnt = 0;
+
+	hash_first (&i, &page_cache);
+	while (hash_next (&i))
+		if (hash_entry (hash_cur (&i), struct page,
+					page_cache.elem)->page_cache.inode == inode)
+			cnt++;
+	// 아직 파일을 연 곳이 있으면 남겨둔다 (매핑도 파일을 열어둔다)
+	struct page **pages = cnt > 0 && cnt == refs
+		? malloc (cnt * sizeof *pages) : NULL;
+	if (pages == NULL) {
+		vm_lock_release (locked);
+		return 0;
+	}
+
+	int n = 0;
+	hash_first (&i, &page_cache);
+	while (hash_next (&i)) {
+		struct page *page = hash_entry (hash_cur (&i), struct page,
+				page_cache.elem);
+		if (page->page_cache.inode == inode)
+			pages[n++] = page;
+	}
+	// 지워진 파일이므로 write back하지 않는다
+	for (n = 0; n < cnt; n++) {
+		ASSERT (list_empty (&pages[n]->page_cache.mappers));
+		hash_delete (&page_cache, &pages[n]->page_cache.elem);
+		vm_frame_free (pages[n]->frame);
+		free (pages[n]);
+		drop_cnt++;
+	}
+	free (pages);
+	vm_lock_release (locked);
+	return cnt;
+}
+
+void
+page_cache_print_stats (void) {
+	printf ("Page cache: %zu pages, %lld hits, %lld misses, "
+			"%lld written back, %lld dropped\n", hash_size (&page_cache),
+			hit_cnt, miss_cnt, writeback_cnt, drop_cnt);
 }
 
 /* Utilze the Swap in mechanism to implement readhead */
 static bool
 page_cache_readahead (struct page *page, void *kva) {
+	struct page_cache *pc = &page->page_cache;
+
+	if (inode_read_at (pc->inode, kva, pc->bytes, pc->offset) != pc->bytes)
+		return false;
+	memset (kva + pc->bytes, 0, PGSIZE - pc->bytes);
+	return true;
 }
 
 /* Utilze the Swap out mechanism to implement writeback */
+/* 매핑한 프로세스의 dirty bit까지 모아서, 수정된 적 있으면 파일에 쓴다.
+ * 공유 page가 파일에 쓰이는 곳은 여기뿐이다. */
 static bool
 page_cache_writeback (struct page *page) {
+	struct page_cache *pc = &page->page_cache;
+	bool dirty = pc->dirty;
+
+	for (struct list_elem *e = list_begin (&pc->mappers);
+			e != list_end (&pc->mappers); e = list_next (e)) {
+		struct page *p = list_entry (e, struct page, file.share_elem);
+		if (pml4_is_dirty (p->owner->pml4, p->va)) {
+			pml4_set_dirty (p->owner->pml4, p->va, false);
+			dirty = true;
+		}
+	}
+	if (dirty) {
+		inode_write_at (pc->inode, page->frame->kva, pc->bytes, pc->offset);
+		write_seq++;
+		writeback_cnt++;
+	}
+	pc->dirty = false;
+	return true;
 }
 
 /* Destory the page_cache. */
 static void
 page_cache_destroy (struct page *page) {
+	struct page_cache *pc = &page->page_cache;
+
+	ASSERT (list_empty (&pc->mappers));
+	hash_delete (&page_cache, &pc->elem);
+	inode_close (pc->inode);
 }
 
 /* Worker thread for page cache */
 static void
-page_cache_kworkerd (void *aux) {
+page_cache_kworkerd (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (PAGE_CACHE_WRITEBACK_TICKS);
+		page_cache_flush ();
+	}
+}
+
+/* Returns how many bytes of the page of INODE at OFFSET are file
+ * contents. */
+static off_t
+page_bytes (struct inode *inode, off_t offset) {
+	off_t bytes = inode_length (inode) - offset;
+	return bytes < 0 ? 0 : bytes > PGSIZE ? PGSIZE : bytes;
+}
+
+static struct page *
+lookup (struct inode *inode, off_t offset) {
+	struct page_cache key;
+	struct hash_elem *e;
+
+	key.inode = inode;
+	key.offset = offset;
+	e = hash_find (&page_cache, &key.elem);
+	return e != NULL ? hash_entry (e, struct page, page_cache.elem) : NULL;
+}
+
+static uint64_t
+page_cache_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct page_cache *pc = hash_entry (e, struct page_cache, elem);
+	return hash_bytes (&pc->inode, sizeof pc->inode) ^ hash_int (pc->offset);
+}
+
+static bool
+page_cache_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct page_cache *a = hash_entry (a_, struct page_cache, elem);
+	const struct page_cache *b = hash_entry (b_, struct page_cache, elem);
+
+	if (a->inode != b->inode)
+		return a->inode < b->inode;
+	return a->offset < b->offset;
 }
+#endif /* VM */
@@ -0,0 +1,22 @@
+#ifndef FILESYS_BUFFER_CACHE_H
+#define FILESYS_BUFFER_CACHE_H
+#include <stddef.h>
+#include "devices/disk.h"
+#include "filesys/off_t.h"
+
+/* Number of sectors kept in the cache. */
+#define BUFFER_CACHE_SIZE 64
+
+/* Ticks between two write-behind passes. */
+#define WRITE_BEHIND_TICKS 100
+
+void buffer_cache_init (void);
+void buffer_cache_read (disk_sector_t sector, void *buffer, off_t ofs,
+		size_t size);
+void buffer_cache_write (disk_sector_t sector, const void *buffer, off_t ofs,
+		size_t size);
+void buffer_cache_readahead (disk_sector_t sector);
+void buffer_cache_flush (void);
+void buffer_cache_print_stats (void);
+
+#endif /* filesys/buffer_cache.h */
@@ -0,0 +1,25 @@
+#ifndef FILESYS_DCACHE_H
+#define FILESYS_DCACHE_H
+#include <stdbool.h>
+#include "devices/disk.h"
+
+/* Number of names kept in the cache. */
+#define DCACHE_SIZE 128
+
+/* Result of a dentry cache lookup. */
+enum dcache_result {
+	DCACHE_MISS,                /* 모름, 디렉토리를 읽어야 함 */
+	DCACHE_FOUND,               /* 있음, sector를 돌려줌 */
+	DCACHE_ABSENT,              /* 없다는 것을 기억하고 있음 */
+};
+
+void dcache_init (void);
+enum dcache_result dcache_lookup (disk_sector_t dir, const char *name,
+		disk_sector_t *sector);
+void dcache_insert (disk_sector_t dir, const char *name, bool found,
+		disk_sector_t sector);
+void dcache_invalidate (disk_sector_t dir, const char *name);
+void dcache_purge (disk_sector_t dir);
+void dcache_print_stats (void);
+
+#endif /* filesys/dcache.h */
@@ -27,6 +27,10 @@ void fat_close (void);
 cluster_t fat_create_chain (
     cluster_t clst /* Cluster # to stretch, 0: Create a new chain */
 );
+cluster_t fat_create_run (
+    cluster_t clst, /* Cluster # to stretch, 0: Create a new chain */
+    size_t cnt      /* Number of clusters to add */
+);
 void fat_remove_chain (
     cluster_t clst, /* Cluster # to be removed */
     cluster_t pclst /* Previous cluster of clst, 0: clst is the start of chain */
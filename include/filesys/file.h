@@ -1,5 +1,6 @@
 #ifndef FILESYS_FILE_H
 #define FILESYS_FILE_H
+#include <stdbool.h>
 #include "filesys/off_t.h"
 
 // /* An open file. */
@@ -24,6 +25,7 @@ off_t file_read (struct file *, void *, off_t);
 off_t file_read_at (struct file *, void *, off_t size, off_t start);
 off_t file_write (struct file *, const void *, off_t);
 off_t file_write_at (struct file *, const void *, off_t size, off_t start);
+bool file_allocate (struct file *, off_t offset, off_t len);
 
 /* Preventing writes. */
 void file_deny_write (struct file *);
@@ -1,12 +1,44 @@
 #ifndef FILESYS_PAGE_CACHE_H
 #define FILESYS_PAGE_CACHE_H
-#include "vm/vm.h"
+#include <hash.h>
+#include <list.h>
+#include <stdbool.h>
+#include "filesys/off_t.h"
 
 struct page;
+struct frame;
+struct inode;
 enum vm_type;
 
-struct page_cache {};
+/* Ticks between two passes of the writeback worker. */
+#define PAGE_CACHE_WRITEBACK_TICKS 200
+
+/* A page of a file held in a frame. read(), write() and every mapping
+ * of the file go through the same page. The page belongs to no process
+ * (page->owner is NULL), so its frame is charged to nobody. */
+struct page_cache {
+	struct inode *inode;		/* key: 파일의 inode (열어둔 채로 유지) */
+	off_t offset;				/* key: 파일 안의 위치 (page 단위) */
+	off_t bytes;				/* frame 안에서 파일 내용인 길이 */
+	bool dirty;					/* 이미 unmap된 매핑이 수정해 둔 적 있음 */
+	bool referenced;			/* 마지막 검사 이후 read()/write()가 썼음 */
+	struct hash_elem elem;		/* page cache index의 element */
+	struct list mappers;		/* 이 page를 매핑한 VM_FILE page들 */
+};
 
 void page_cache_init (void);
+void pagecache_init (void);
 bool page_cache_initializer (struct page *page, enum vm_type type, void *kva);
+struct page *page_cache_get (struct inode *inode, off_t offset, bool evict);
+void page_cache_sync (struct page *page);
+void page_cache_flush (void);
+off_t page_cache_read (struct inode *inode, void *buffer, off_t size,
+		off_t offset);
+off_t page_cache_write (struct inode *inode, const void *buffer, off_t size,
+		off_t offset);
+bool page_cache_test_and_clear_accessed (struct frame *frame);
+bool page_cache_is_dirty (struct frame *frame);
+void page_cache_drop (struct frame *frame);
+int page_cache_forget (struct inode *inode, int refs);
+void page_cache_print_stats (void);
 #endif
@@ -36,6 +36,26 @@ static __inline void invlpg(uint64_t addr) {
 	__asm __volatile("invlpg (%0)" : : "r" (addr) : "memory");
 }
 
+/* Invalidates the TLB entries tagged with PCID according to TYPE.
+   See [IA32-v2a] "INVPCID--Invalidate Process-Context Identifier". */
+#define INVPCID_ADDR 0		/* One address in one PCID. */
+#define INVPCID_PCID 1		/* All non-global entries of one PCID. */
+#define INVPCID_ALL 2		/* All entries, including global ones. */
+
+__attribute__((always_inline))
+static __inline void invpcid(uint64_t type, uint16_t pcid, uint64_t addr) {
+	struct { uint64_t pcid; uint64_t addr; } desc = { pcid, addr };
+	__asm __volatile("invpcid %0, %1" : : "m" (desc), "r" (type) : "memory");
+}
+
+__attribute__((always_inline))
+static __inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t *a,
+		uint32_t *b, uint32_t *c, uint32_t *d) {
+	__asm __volatile("cpuid"
+			: "=a" (*a), "=b" (*b), "=c" (*c), "=d" (*d)
+			: "a" (leaf), "c" (subleaf));
+}
+
 __attribute__((always_inline))
 static __inline uint64_t read_eflags(void) {
 	uint64_t rflags;
@@ -50,6 +70,18 @@ static __inline uint64_t rcr3(void) {
 	return val;
 }
 
+__attribute__((always_inline))
+static __inline uint64_t rcr4(void) {
+	uint64_t val;
+	__asm __volatile("movq %%cr4,%0" : "=r" (val));
+	return val;
+}
+
+__attribute__((always_inline))
+static __inline void lcr4(uint64_t val) {
+	__asm __volatile("movq %0, %%cr4" : : "r" (val) : "memory");
+}
+
 __attribute__((always_inline))
 static __inline uint64_t rrax(void) {
 	uint64_t val;
@@ -119,6 +151,14 @@ static __inline uint64_t rcr2(void) {
 	return val;
 }
 
+/* Reads the time-stamp counter. */
+__attribute__((always_inline))
+static __inline uint64_t rdtsc(void) {
+	uint32_t lo, hi;
+	__asm __volatile("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t) hi << 32) | lo;
+}
+
 __attribute__((always_inline))
 static __inline void write_msr(uint32_t ecx, uint64_t val) {
 	uint32_t edx, eax;
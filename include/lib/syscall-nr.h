@@ -36,6 +36,14 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Extra for Project 3 */
+	SYS_MADVISE,                /* Give a hint about memory usage. */
+	SYS_RSSLIMIT,               /* Set the resident frame quota. */
+	SYS_MEMMERGE,               /* Allow merging of identical pages. */
+
+	/* Extra for Project 4 */
+	SYS_FALLOCATE,              /* Reserve space for a file. */
 };
 
 #endif /* lib/syscall-nr.h */
@@ -41,6 +41,16 @@ int dup2(int oldfd, int newfd);
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
+int madvise (void *addr, size_t length, int advice);
+size_t rsslimit (size_t frames);
+bool memmerge (bool enable);
+
+/* Values for madvise()'s ADVICE. */
+#define MADV_NORMAL 0           /* No special treatment. */
+#define MADV_RANDOM 1           /* Expect random accesses. */
+#define MADV_SEQUENTIAL 2       /* Expect sequential accesses. */
+#define MADV_WILLNEED 3         /* Will be accessed soon. */
+#define MADV_DONTNEED 4         /* Contents can be dropped. */
 
 /* Project 4 only. */
 bool chdir (const char *dir);
@@ -49,6 +59,7 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 int symlink (const char* target, const char* linkpath);
+int fallocate (int fd, off_t offset, off_t len);
 
 static inline void* get_phys_addr (void *user_addr) {
 	void* pa;
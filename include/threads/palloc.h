@@ -2,6 +2,7 @@
 #define THREADS_PALLOC_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 /* How to allocate pages. */
@@ -19,5 +20,15 @@ void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+size_t palloc_user_free_cnt (void);
+size_t palloc_page_cnt (void);
+size_t palloc_page_idx (const void *);
+void palloc_print_stats (void);
+size_t palloc_user_page_cnt (void);
+size_t palloc_user_page_idx (const void *);
+void *palloc_user_page (size_t idx);
+bool palloc_user_page_used (size_t idx);
+void *palloc_user_get_range (size_t idx, size_t cnt);
+void *palloc_user_get_outside (size_t idx, size_t cnt);
 
 #endif /* threads/palloc.h */
@@ -118,7 +118,13 @@ struct thread
 	// --------------------project3 Anonymous Page start---------
 	void* stack_bottom;
 	void* rsp_stack;
-	void* mmap_addr;	// munmap 확인용
+	void* fa_next;		// 순차 접근이면 다음 fault가 날 주소 (fault-around)
+	size_t fa_window;	// 현재 fault-around window 크기 (페이지 수)
+	size_t rss;			// 이 프로세스에 charge된 frame 수
+	size_t rss_limit;	// frame quota, 0이면 제한 없음
+	bool ksm_merge;		// ksmd가 이 프로세스의 page를 합쳐도 되는지 (memmerge())
+	struct list_elem ksm_elem;	// ksmd가 돌아볼 프로세스 list의 element
+	struct list_elem vm_elem;	// 주소 공간 list의 element (page table을 훑는 eviction 정책용)
 	// --------------------project3 Anonymous Page end---------
 #endif
 
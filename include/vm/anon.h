@@ -4,13 +4,36 @@
 #include "threads/vaddr.h"  //  추가
 struct page;
 enum vm_type;
+struct zswap_entry;
+struct ksm_node;
 
 struct anon_page {
     // struct page anon_p; // heesan 주의☠️ ??
     int swap_location;   // swap disk 위치
+    struct zswap_entry *zswap;   // 압축되어 RAM(zswap)에 있으면 해당 entry
+    bool same_filled;   // 한 8byte word로만 채워진 채로 쫓겨났으면 true
+    uint64_t fill;      // same_filled일 때 페이지를 채우고 있던 word
+
+    /* Same-page merging (vm/ksm.c). */
+    struct ksm_node *ksm;            // 공유 frame에 합쳐졌으면 그 node
+    struct list_elem ksm_share_elem; // ksm->pages의 element
+    struct hash_elem ksm_elem;       // 후보일 때 unstable table의 element
+    bool ksm_unstable;               // unstable table에 있음
+    bool ksm_seen;                   // ksm_csum이 유효함
+    uint64_t ksm_csum;               // 지난 scan 때의 checksum
 };
 
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
+bool anon_discard (struct page *page);
+bool anon_is_zero (struct page *page);
+bool page_is_anon (struct page *page);
+
+//-------project3-swap in out start----------------
+size_t swap_slot_write (const void *kva);
+void swap_slot_read (size_t slot, void *kva);
+void swap_slot_free (size_t slot);
+void anon_print_stats (void);
+//-------project3-swap in out end----------------
 
 #endif
@@ -0,0 +1,8 @@
+#ifndef VM_COMPACT_H
+#define VM_COMPACT_H
+#include <stddef.h>
+
+void *compact_alloc (size_t page_cnt, size_t align);
+void compact_print_stats (void);
+
+#endif /* vm/compact.h */
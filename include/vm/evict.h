@@ -0,0 +1,28 @@
+#ifndef VM_EVICT_H
+#define VM_EVICT_H
+#include <stdbool.h>
+
+struct frame;
+
+/* An eviction policy. The VM calls add() for every frame it takes from
+ * the user pool and remove() before giving one back. victim() picks a
+ * frame with a page to evict; the caller evicts it and either frees it
+ * or fills it again, so the policy treats it as newly added and a
+ * second call picks a different frame if there is one. All of these
+ * run with the VM lock held. */
+struct evict_policy {
+	const char *name;
+	void (*init) (void);
+	void (*add) (struct frame *frame);
+	void (*remove) (struct frame *frame);
+	struct frame *(*victim) (void);
+	void (*print_stats) (void);
+};
+
+extern const struct evict_policy *evict_policy;
+extern const struct evict_policy clock_policy;
+extern const struct evict_policy mglru_policy;
+
+bool evict_select (const char *name);
+
+#endif /* vm/evict.h */
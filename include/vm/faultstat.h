@@ -0,0 +1,34 @@
+#ifndef VM_FAULTSTAT_H
+#define VM_FAULTSTAT_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/* What a page fault had to do, from cheapest to most expensive. A fault
+ * is counted under the most expensive step it took. */
+enum fault_kind {
+	FAULT_MINOR,		/* frame만 붙이면 됨 (새 anon page, zero page, 공유 frame) */
+	FAULT_STACK,		/* stack을 늘림 */
+	FAULT_FILE,			/* 파일에서 읽음 */
+	FAULT_SWAP_IN,		/* swap disk나 zswap에서 읽음 */
+	FAULT_EVICT,		/* fault가 아니라 frame 하나를 evict하는 데 걸린 시간 */
+	FAULT_KIND_CNT
+};
+
+/* Latency histogram buckets: bucket K counts events that took
+ * [2^K, 2^(K+1)) TSC cycles. The last one also takes anything longer. */
+#define FAULTSTAT_BUCKETS 40
+
+/* Print a trace line for every page fault.
+   Controlled by kernel command-line option "-ftrace". */
+extern bool fault_trace;
+
+void faultstat_init (void);
+uint64_t faultstat_now (void);
+void faultstat_begin (void);
+void faultstat_note (enum fault_kind kind);
+void faultstat_end (uint64_t start);
+void faultstat_trace (const void *va, bool write);
+void faultstat_record (enum fault_kind kind, uint64_t start);
+void faultstat_print_stats (void);
+
+#endif /* vm/faultstat.h */
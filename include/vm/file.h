@@ -7,12 +7,16 @@ struct page;
 enum vm_type;
 
 //-------project3-memory_management-start--------------
+struct frame;
+
 struct file_page {
 	// --------------------project3 Anonymous Page start---------
 	struct file *file;
 	size_t length;
 	off_t offset;
 	// --------------------project3 Anonymous Page end---------
+	struct page *cache;				// 매핑 중이면 같은 파일의 다른 매핑과 공유하는 page cache page
+	struct list_elem share_elem;	// cache->page_cache.mappers의 element
 };
 //-------project3-memory_management-end----------------
 
@@ -21,4 +25,11 @@ bool file_backed_initializer (struct page *page, enum vm_type type, void *kva);
 void *do_mmap(void *addr, size_t length, int writable,
 		struct file *file, off_t offset);
 void do_munmap (void *va);
+struct vm_area;
+struct page *mmap_page_create (struct vm_area *vma, void *va);
+
+//-------project3-shared-mmap-start--------------
+bool mmap_claim (struct page *page, bool evict);
+void mmap_release (struct page *page);
+//-------project3-shared-mmap-end----------------
 #endif
@@ -0,0 +1,14 @@
+#ifndef VM_HUGE_H
+#define VM_HUGE_H
+#include <stdbool.h>
+
+struct page;
+
+/* Map suitable anonymous regions with 2MB pages.
+   Controlled by kernel command-line option "-thp". */
+extern bool huge_pages;
+
+bool huge_fault (struct page *page);
+void huge_print_stats (void);
+
+#endif /* vm/huge.h */
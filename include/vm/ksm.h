@@ -0,0 +1,27 @@
+#ifndef VM_KSM_H
+#define VM_KSM_H
+#include <stdbool.h>
+
+struct page;
+struct frame;
+struct thread;
+
+/* Ticks ksmd sleeps between scanning two processes. */
+#define KSM_SLEEP_TICKS 20
+
+/* Starts ksmd at boot. Controlled by kernel command-line option "-ksm". */
+extern bool ksm_enabled;
+
+void ksm_init (void);
+bool ksm_set (bool merge);
+void ksm_enter (struct thread *t);
+void ksm_leave (struct thread *t);
+bool ksm_is_merged (struct page *page);
+bool ksm_break (struct page *page);
+void ksm_unshare (struct page *page);
+void ksm_drop (struct frame *frame);
+void ksm_forget (struct page *page);
+bool ksm_test_and_clear_accessed (struct frame *frame);
+void ksm_print_stats (void);
+
+#endif /* vm/ksm.h */
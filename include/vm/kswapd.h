@@ -0,0 +1,12 @@
+#ifndef VM_KSWAPD_H
+#define VM_KSWAPD_H
+#include <stddef.h>
+
+/* Frames reclaimed per batch. kswapd drops the VM lock between batches. */
+#define KSWAPD_BATCH 16
+
+void kswapd_init (void);
+void kswapd_check (void);
+void kswapd_print_stats (void);
+
+#endif /* vm/kswapd.h */
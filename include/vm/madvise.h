@@ -0,0 +1,23 @@
+#ifndef VM_MADVISE_H
+#define VM_MADVISE_H
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Advice values for madvise(). Must match lib/user/syscall.h. */
+#define MADV_NORMAL 0		/* 기본 동작 */
+#define MADV_RANDOM 1		/* fault-around를 하지 않음 */
+#define MADV_SEQUENTIAL 2	/* fault-around 최대, 한 window 뒤의 accessed bit를 지움 */
+#define MADV_WILLNEED 3		/* 미리 비동기로 올려둠 */
+#define MADV_DONTNEED 4		/* 지금 바로 버림 */
+
+struct supplemental_page_table;
+
+void madvise_init (void);
+int do_madvise (void *addr, size_t length, int advice);
+int madvise_advice (struct supplemental_page_table *spt, void *va);
+bool madvise_copy (struct supplemental_page_table *dst,
+		struct supplemental_page_table *src);
+void madvise_kill (struct supplemental_page_table *spt);
+void madvise_print_stats (void);
+
+#endif /* vm/madvise.h */
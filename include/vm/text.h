@@ -0,0 +1,28 @@
+#ifndef VM_TEXT_H
+#define VM_TEXT_H
+#include <list.h>
+#include <stdbool.h>
+
+struct page;
+struct frame;
+struct container;
+struct text_entry;
+
+/* Read-only segment page whose frame is shared by every process that
+ * maps the same (inode, offset) of the same executable. */
+struct text_page {
+	struct container *aux;			/* 어디서 읽어오는지 (file, offset, page_read_bytes) */
+	struct text_entry *entry;		/* 매핑 중이면 공유 cache entry */
+	struct list_elem share_elem;	/* entry->pages의 element */
+};
+
+void vm_text_init (void);
+bool page_is_shareable (struct page *page);
+bool page_is_text (struct page *page);
+bool text_claim (struct page *page, bool evict);
+void text_unshare (struct page *page);
+void text_drop (struct frame *frame);
+bool text_test_and_clear_accessed (struct frame *frame);
+void text_print_stats (void);
+
+#endif /* vm/text.h */
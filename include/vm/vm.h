@@ -28,9 +28,9 @@ enum vm_type {
 #include "vm/uninit.h"
 #include "vm/anon.h"
 #include "vm/file.h"
-#ifdef EFILESYS
+#include "vm/text.h"
+#include "vm/vma.h"
 #include "filesys/page_cache.h"
-#endif
 
 struct page_operations;
 struct thread;
@@ -54,6 +54,7 @@ struct page {
 	// spt에서 페이지를 찾기 위해서 hash_elem 필요함. 
 	// 이 hash_elem을 타고 struct page로 가서 메타데이터를 알 수 있음
 	struct hash_elem hash_elem; 
+	struct thread *owner;	// 이 page를 가진 프로세스 (evict할 때 pml4를 찾기 위해)
 
 	//-------project3-memory_management-end----------------
 	
@@ -71,9 +72,12 @@ struct page {
 
 		// 파일으로부터 매핑된 페이지
 		struct file_page file;
-#ifdef EFILESYS
+
+		// 여러 프로세스가 frame을 공유하는 read-only segment 페이지
+		struct text_page text;
+
+		// 파일의 한 page를 read()/write()와 모든 매핑이 공유하는 page cache page
 		struct page_cache page_cache;
-#endif
 	};
 	bool writable; // wrtie 가능한지 여부
 };
@@ -84,6 +88,10 @@ struct frame {
 	void *kva; // 커널 가상 주소: 물리메모리 프레임이랑 일대일로 매핑되어 있는 가상 주소
 	struct page *page; // 페이지 구조
 	struct list_elem frame_elem; // 
+	struct text_entry *text; // 공유 text frame이면 cache entry, 아니면 NULL
+	struct ksm_node *ksm; // 같은 내용의 anon page들이 공유하는 frame이면 node, 아니면 NULL
+	struct list_elem lru_elem; // eviction 정책이 관리하는 list의 element
+	unsigned gen; // mglru: 이 frame이 속한 generation
 };
 
 /* The function table for page operations.
@@ -109,6 +117,8 @@ struct page_operations {
  * All designs up to you for this. */
 struct supplemental_page_table {
 	struct hash spt_hash;
+	struct vma_tree vmas;			// mmap()으로 매핑한 구간들
+	struct list madvise_regions;	// madvise() hint 구간들 (start 순)
 };
 
 #include "threads/thread.h"
@@ -121,8 +131,24 @@ struct page *spt_find_page (struct supplemental_page_table *spt,
 bool spt_insert_page (struct supplemental_page_table *spt, struct page *page);
 void spt_remove_page (struct supplemental_page_table *spt, struct page *page);
 bool spt_delete_page(struct supplemental_page_table *spt, struct page *page);
+bool spt_range_empty (struct supplemental_page_table *spt, void *start,
+		void *end);
+void spt_destroy_range (struct supplemental_page_table *spt, void *start,
+		void *end);
+
+/* Maximum fault-around window, in pages. */
+#define FAULT_AROUND_MAX 32
+
+/* Number of pages read per fault on a file-backed page.
+   Controlled by kernel command-line option "-fa=N"; 0 disables it. */
+extern size_t fault_around_pages;
+
+/* Default frame quota of a process, in frames; 0 means no limit.
+   Controlled by kernel command-line option "-rss=N". */
+extern size_t rss_limit_default;
 
 void vm_init (void);
+void vm_print_stats (void);
 bool vm_try_handle_fault (struct intr_frame *f, void *addr, bool user,
 		bool write, bool not_present);
 
@@ -132,8 +158,32 @@ bool vm_alloc_page_with_initializer (enum vm_type type, void *upage,
 		bool writable, vm_initializer *init, void *aux);
 void vm_dealloc_page (struct page *page);
 bool vm_claim_page (void *va);
+struct frame *vm_get_frame (void);
+struct frame *vm_try_get_frame (void);
+struct frame *vm_frame_create (void *kva);
+bool vm_do_claim_frame (struct page *page, struct frame *frame);
+void vm_frame_free (struct frame *frame);
+void vm_frame_set_page (struct frame *frame, struct page *page);
+struct frame *vm_frame_lookup (void *kva);
+void vm_frame_move (struct frame *frame, void *kva);
+bool vm_frame_accessed (struct frame *frame);
+void vm_space_enter (struct thread *t);
+void vm_space_leave (struct thread *t);
+void vm_for_each_space (bool (*func) (struct thread *, void *), void *aux);
+size_t vm_set_rss_limit (size_t frames);
+void vm_free_frame (struct page *page);
+size_t vm_reclaim (size_t cnt, size_t *written);
+bool vm_prefetch_page (struct page *page);
+bool vm_page_discard (struct page *page);
+bool vm_install_page (struct page *page, void *kva, bool writable);
 enum vm_type page_get_type (struct page *page);
 
+/* Serializes page faults, the prefetch thread and address space changes.
+   vm_lock_acquire() returns false if the caller already held the lock;
+   pass its result to vm_lock_release(). */
+bool vm_lock_acquire (void);
+void vm_lock_release (bool locked);
+
 bool
 page_less (const struct hash_elem *a_,
            const struct hash_elem *b_, void *aux UNUSED);
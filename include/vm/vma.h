@@ -0,0 +1,49 @@
+#ifndef VM_VMA_H
+#define VM_VMA_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+/* Protection bits of a vm_area. */
+#define VMA_READ 0x1
+#define VMA_WRITE 0x2
+
+/* Flags of a vm_area. */
+#define VMA_SHARED 0x1		/* 같은 파일을 매핑한 프로세스와 frame 공유 */
+
+/* A mapped region [start, end) of a process's address space. Only the
+ * region is recorded by mmap(); the struct page for each address in it
+ * is created on the first fault there. */
+struct vm_area {
+	void *start;			/* 첫 page 주소 */
+	void *end;				/* 마지막 page 다음 주소 */
+	struct file *file;		/* 이 매핑이 따로 열어둔 파일 */
+	off_t offset;			/* start에 매핑되는 파일 위치 */
+	size_t file_bytes;		/* start부터 파일 내용이 있는 길이 (나머지는 0) */
+	int prot;				/* VMA_READ | VMA_WRITE */
+	int flags;				/* VMA_SHARED */
+
+	/* Interval tree node, ordered by start. */
+	struct vm_area *left;
+	struct vm_area *right;
+	int height;				/* AVL 균형용 높이 */
+	void *max_end;			/* subtree 안에서 가장 큰 end */
+};
+
+/* Per-process set of vm_areas. */
+struct vma_tree {
+	struct vm_area *root;
+	size_t cnt;
+};
+
+void vma_tree_init (struct vma_tree *tree);
+void vma_insert (struct vma_tree *tree, struct vm_area *vma);
+void vma_remove (struct vma_tree *tree, struct vm_area *vma);
+struct vm_area *vma_find (struct vma_tree *tree, const void *addr);
+struct vm_area *vma_overlap (struct vma_tree *tree, const void *start,
+		const void *end);
+bool vma_tree_copy (struct vma_tree *dst, struct vma_tree *src);
+void vma_tree_destroy (struct vma_tree *tree);
+void vma_free (struct vm_area *vma);
+
+#endif /* vm/vma.h */
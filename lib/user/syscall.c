@@ -155,6 +155,21 @@ munmap (void *addr) {
 	syscall1 (SYS_MUNMAP, addr);
 }
 
+int
+madvise (void *addr, size_t length, int advice) {
+	return syscall3 (SYS_MADVISE, addr, length, advice);
+}
+
+size_t
+rsslimit (size_t frames) {
+	return syscall1 (SYS_RSSLIMIT, frames);
+}
+
+bool
+memmerge (bool enable) {
+	return syscall1 (SYS_MEMMERGE, enable);
+}
+
 bool
 chdir (const char *dir) {
 	return syscall1 (SYS_CHDIR, dir);
@@ -185,6 +200,11 @@ symlink (const char* target, const char* linkpath) {
 	return syscall2 (SYS_SYMLINK, target, linkpath);
 }
 
+int
+fallocate (int fd, off_t offset, off_t len) {
+	return syscall3 (SYS_FALLOCATE, fd, offset, len);
+}
+
 int
 mount (const char *path, int chan_no, int dev_no) {
 	return syscall3 (SYS_MOUNT, path, chan_no, dev_no);
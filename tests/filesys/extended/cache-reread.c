@@ -0,0 +1,45 @@
+/* Writes a file, reopens it and reads it twice. The second read must
+   be served from the cache without reading the disk. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define TEST_SIZE 16384
+
+static const char file_name[] = "reread";
+static char buf[TEST_SIZE];
+static char buf2[TEST_SIZE];
+
+void
+test_main (void)
+{
+  long long read_cnt;
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (write (fd, buf, sizeof buf) == TEST_SIZE, "write \"%s\"", file_name);
+  msg ("close \"%s\"", file_name);
+  close (fd);
+
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (read (fd, buf2, sizeof buf2) == TEST_SIZE, "read \"%s\"", file_name);
+  if (memcmp (buf, buf2, sizeof buf))
+    fail ("first read of \"%s\" reported bad data", file_name);
+
+  read_cnt = get_fs_disk_read_cnt ();
+  memset (buf2, 0, sizeof buf2);
+  seek (fd, 0);
+  CHECK (read (fd, buf2, sizeof buf2) == TEST_SIZE, "read \"%s\" again",
+         file_name);
+  if (memcmp (buf, buf2, sizeof buf))
+    fail ("second read of \"%s\" reported bad data", file_name);
+  CHECK (get_fs_disk_read_cnt () == read_cnt, "second read hit the cache");
+
+  msg ("close \"%s\"", file_name);
+  close (fd);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(cache-reread) begin
+(cache-reread) create "reread"
+(cache-reread) open "reread"
+(cache-reread) write "reread"
+(cache-reread) close "reread"
+(cache-reread) open "reread"
+(cache-reread) read "reread"
+(cache-reread) read "reread" again
+(cache-reread) second read hit the cache
+(cache-reread) close "reread"
+(cache-reread) end
+EOF
+pass;
@@ -0,0 +1,9 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my ($fs);
+$fs->{"n$_"} = ["\0" x $_] foreach grep ($_ % 2 == 0, 0...199);
+$fs->{"late"} = [''];
+check_archive ($fs);
+pass;
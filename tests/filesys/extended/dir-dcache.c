@@ -0,0 +1,77 @@
+/* Checks that repeated name lookups stay correct: a name that was
+   looked up and missed can be created and opened, a removed name stops
+   resolving, a recreated name resolves to the new file, and paths
+   through "." and ".." resolve the same file. Then looks up more names
+   than the lookup cache holds and checks every answer. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define NAME_CNT 200
+
+static void
+check_opens (const char *name, int size)
+{
+  int fd = open (name);
+  if (fd < 2)
+    fail ("open \"%s\" failed", name);
+  if (filesize (fd) != size)
+    fail ("\"%s\" has size %d instead of %d", name, filesize (fd), size);
+  close (fd);
+}
+
+void
+test_main (void)
+{
+  char name[16];
+  int i, fd;
+
+  CHECK (open ("late") == -1, "open missing \"late\" fails");
+  CHECK (open ("late") == -1, "open missing \"late\" fails again");
+  CHECK (create ("late", 0), "create \"late\"");
+  check_opens ("late", 0);
+  msg ("open \"late\" after creating it");
+
+  CHECK ((fd = open ("late")) > 1, "open \"late\"");
+  CHECK (write (fd, "old", 3) == 3, "write \"old\"");
+  close (fd);
+  check_opens ("/late", 3);
+  check_opens ("./late", 3);
+  check_opens ("/./late", 3);
+  check_opens ("/../late", 3);
+  msg ("open \"late\" through other paths");
+
+  CHECK (remove ("late"), "remove \"late\"");
+  CHECK (open ("late") == -1, "open removed \"late\" fails");
+  CHECK (open ("./late") == -1, "open removed \"./late\" fails");
+  CHECK (create ("late", 0), "create \"late\" again");
+  check_opens ("late", 0);
+  check_opens ("./late", 0);
+  msg ("open recreated \"late\"");
+
+  for (i = 0; i < NAME_CNT; i += 2)
+    {
+      snprintf (name, sizeof name, "n%d", i);
+      if (!create (name, i))
+        fail ("create \"%s\" failed", name);
+    }
+  for (i = 0; i < NAME_CNT; i++)
+    {
+      snprintf (name, sizeof name, "n%d", i);
+      if (i % 2 == 0)
+        check_opens (name, i);
+      else if (open (name) != -1)
+        fail ("missing \"%s\" can be opened", name);
+    }
+  for (i = NAME_CNT - 1; i >= 0; i--)
+    {
+      snprintf (name, sizeof name, "n%d", i);
+      if (i % 2 == 0)
+        check_opens (name, i);
+      else if (open (name) != -1)
+        fail ("missing \"%s\" can be opened", name);
+    }
+  msg ("looked up %d names twice", NAME_CNT);
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-dcache) begin
+(dir-dcache) open missing "late" fails
+(dir-dcache) open missing "late" fails again
+(dir-dcache) create "late"
+(dir-dcache) open "late" after creating it
+(dir-dcache) open "late"
+(dir-dcache) write "old"
+(dir-dcache) open "late" through other paths
+(dir-dcache) remove "late"
+(dir-dcache) open removed "late" fails
+(dir-dcache) open removed "./late" fails
+(dir-dcache) create "late" again
+(dir-dcache) open recreated "late"
+(dir-dcache) looked up 200 names twice
+(dir-dcache) end
+EOF
+pass;
@@ -0,0 +1,8 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my ($fs);
+$fs->{"f$_"} = [''] foreach grep ($_ % 2 || $_ % 6 == 0, 0...299);
+check_archive ($fs);
+pass;
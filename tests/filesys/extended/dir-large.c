@@ -0,0 +1,67 @@
+/* Creates many files in the root directory, looks each of them up,
+   removes every other one, and checks that only the removed names are
+   gone. Then creates the removed names again. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 300
+
+void
+test_main (void)
+{
+  char name[16];
+  int i, fd;
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      snprintf (name, sizeof name, "f%d", i);
+      if (!create (name, 0))
+        fail ("create \"%s\" failed", name);
+    }
+  msg ("created %d files", FILE_CNT);
+  CHECK (!create ("f150", 0), "create existing \"f150\" fails");
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      snprintf (name, sizeof name, "f%d", i);
+      if ((fd = open (name)) < 2)
+        fail ("open \"%s\" failed", name);
+      close (fd);
+    }
+  msg ("looked up %d files", FILE_CNT);
+
+  for (i = 0; i < FILE_CNT; i += 2)
+    {
+      snprintf (name, sizeof name, "f%d", i);
+      if (!remove (name))
+        fail ("remove \"%s\" failed", name);
+    }
+  msg ("removed every other file");
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      snprintf (name, sizeof name, "f%d", i);
+      fd = open (name);
+      if (i % 2 == 0 && fd != -1)
+        fail ("removed \"%s\" can still be opened", name);
+      if (i % 2 == 1 && fd < 2)
+        fail ("open \"%s\" failed", name);
+      if (fd > 1)
+        close (fd);
+    }
+  msg ("only the removed files are gone");
+
+  for (i = 0; i < FILE_CNT; i += 6)
+    {
+      snprintf (name, sizeof name, "f%d", i);
+      if (!create (name, 0))
+        fail ("create \"%s\" again failed", name);
+      if ((fd = open (name)) < 2)
+        fail ("open recreated \"%s\" failed", name);
+      close (fd);
+    }
+  msg ("recreated every sixth file");
+}
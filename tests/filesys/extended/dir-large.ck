@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-large) begin
+(dir-large) created 300 files
+(dir-large) create existing "f150" fails
+(dir-large) looked up 300 files
+(dir-large) removed every other file
+(dir-large) only the removed files are gone
+(dir-large) recreated every sixth file
+(dir-large) end
+EOF
+pass;
@@ -0,0 +1,7 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_archive ({"prealloc" => ["hello" . "\0" x 14995
+                               . "world" . "\0" x 4995]});
+pass;
@@ -0,0 +1,55 @@
+/* Extends a file with fallocate() and checks that the new part reads
+   as zeros through read() and through a mapping, that data written
+   there sticks, and that bad arguments are rejected. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE 20000
+
+static char buf[FILE_SIZE];
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  int handle;
+  void *map;
+  size_t i;
+
+  CHECK (create ("prealloc", 0), "create \"prealloc\"");
+  CHECK ((handle = open ("prealloc")) > 1, "open \"prealloc\"");
+  CHECK (write (handle, "hello", 5) == 5, "write \"hello\"");
+
+  CHECK (fallocate (handle, 0, FILE_SIZE) == 0, "fallocate %d bytes",
+         FILE_SIZE);
+  CHECK (filesize (handle) == FILE_SIZE, "filesize is %d", FILE_SIZE);
+  CHECK (fallocate (handle, 0, 100) == 0, "fallocate inside the file");
+  CHECK (filesize (handle) == FILE_SIZE, "filesize is still %d", FILE_SIZE);
+  CHECK (fallocate (handle, 0, -1) == -1, "reject negative length");
+  CHECK (fallocate (123, 0, 100) == -1, "reject bad fd");
+
+  seek (handle, 0);
+  CHECK (read (handle, buf, FILE_SIZE) == FILE_SIZE, "read \"prealloc\"");
+  if (memcmp (buf, "hello", 5))
+    fail ("data before fallocate was lost");
+  for (i = 5; i < FILE_SIZE; i++)
+    if (buf[i] != 0)
+      fail ("byte %zu has value %02hhx (should be 0)", i, buf[i]);
+
+  seek (handle, 15000);
+  CHECK (write (handle, "world", 5) == 5, "write \"world\" at 15000");
+  CHECK ((map = mmap (actual, FILE_SIZE, 0, handle, 0)) != MAP_FAILED,
+         "mmap \"prealloc\"");
+  if (memcmp (actual, "hello", 5) || memcmp (actual + 15000, "world", 5))
+    fail ("read of mmap'd file reported bad data");
+  for (i = 15005; i < FILE_SIZE; i++)
+    if (actual[i] != 0)
+      fail ("byte %zu of mmap'd region has value %02hhx (should be 0)",
+            i, actual[i]);
+
+  munmap (map);
+  close (handle);
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fallocate) begin
+(fallocate) create "prealloc"
+(fallocate) open "prealloc"
+(fallocate) write "hello"
+(fallocate) fallocate 20000 bytes
+(fallocate) filesize is 20000
+(fallocate) fallocate inside the file
+(fallocate) filesize is still 20000
+(fallocate) reject negative length
+(fallocate) reject bad fd
+(fallocate) read "prealloc"
+(fallocate) write "world" at 15000
+(fallocate) mmap "prealloc"
+(fallocate) end
+EOF
+pass;
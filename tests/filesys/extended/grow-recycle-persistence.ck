@@ -0,0 +1,6 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_archive ({"big" => ["e" x 500000], "small" => ["small"]});
+pass;
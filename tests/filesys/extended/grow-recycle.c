@@ -0,0 +1,67 @@
+/* Creates a large file, removes it and creates it again several times,
+   writing more in total than the disk holds, so that the clusters of
+   the removed files have to be reused. A small file created between
+   rounds stays in place the whole time. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE 500000
+#define BLOCK_SIZE 8192
+#define ROUND_CNT 5
+
+static char block[BLOCK_SIZE];
+static char check[BLOCK_SIZE];
+
+static void
+write_big (int round)
+{
+  size_t ofs;
+  int fd;
+
+  memset (block, 'a' + round, sizeof block);
+  if (!create ("big", 0))
+    fail ("create \"big\" failed in round %d", round);
+  if ((fd = open ("big")) < 2)
+    fail ("open \"big\" failed in round %d", round);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += BLOCK_SIZE)
+    {
+      size_t size = FILE_SIZE - ofs < BLOCK_SIZE ? FILE_SIZE - ofs : BLOCK_SIZE;
+      if (write (fd, block, size) != (int) size)
+        fail ("write at offset %zu failed in round %d", ofs, round);
+    }
+
+  seek (fd, 0);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += BLOCK_SIZE)
+    {
+      size_t size = FILE_SIZE - ofs < BLOCK_SIZE ? FILE_SIZE - ofs : BLOCK_SIZE;
+      if (read (fd, check, size) != (int) size
+          || memcmp (check, block, size))
+        fail ("read at offset %zu reported bad data in round %d", ofs, round);
+    }
+  close (fd);
+}
+
+void
+test_main (void)
+{
+  int round, fd;
+
+  CHECK (create ("small", 0), "create \"small\"");
+  for (round = 0; round < ROUND_CNT; round++)
+    {
+      write_big (round);
+      if (round == 0)
+        {
+          CHECK ((fd = open ("small")) > 1, "open \"small\"");
+          CHECK (write (fd, "small", 5) == 5, "write \"small\"");
+          close (fd);
+        }
+      if (round < ROUND_CNT - 1 && !remove ("big"))
+        fail ("remove \"big\" failed in round %d", round);
+    }
+  msg ("wrote \"big\" %d times", ROUND_CNT);
+  check_file ("small", "small", 5);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(grow-recycle) begin
+(grow-recycle) create "small"
+(grow-recycle) open "small"
+(grow-recycle) write "small"
+(grow-recycle) wrote "big" 5 times
+(grow-recycle) open "small" for verification
+(grow-recycle) verified contents of "small"
+(grow-recycle) close "small"
+(grow-recycle) end
+EOF
+pass;
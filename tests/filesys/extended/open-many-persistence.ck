@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my ($fs);
+$fs->{"file$_"} = ["file$_" . "\0" x (16 - length "file$_")] foreach 0...19;
+$fs->{"file7"} = ["shared" . "\0" x 10];
+delete $fs->{"file3"};
+check_archive ($fs);
+pass;
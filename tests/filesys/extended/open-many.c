@@ -0,0 +1,64 @@
+/* Opens many files at once, writes each one's name into it, and
+   checks the data after closing and reopening them all. Also opens one
+   file twice and checks that data written through one descriptor is
+   read through the other, and that a removed file stays readable
+   through a descriptor that is still open. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 20
+
+void
+test_main (void)
+{
+  int fds[FILE_CNT];
+  char name[16], buf[16];
+  int i, fd;
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      snprintf (name, sizeof name, "file%d", i);
+      if (!create (name, 0))
+        fail ("create \"%s\" failed", name);
+      if ((fds[i] = open (name)) < 2)
+        fail ("open \"%s\" failed", name);
+      if (write (fds[i], name, sizeof name) != sizeof name)
+        fail ("write \"%s\" failed", name);
+    }
+  msg ("opened and wrote %d files", FILE_CNT);
+
+  CHECK ((fd = open ("file7")) > 1, "open \"file7\" again");
+  CHECK (fd != fds[7], "second open gets a new descriptor");
+  seek (fds[7], 0);
+  CHECK (write (fds[7], "shared", 7) == 7, "write \"shared\" to \"file7\"");
+  CHECK (read (fd, buf, 7) == 7 && !strcmp (buf, "shared"),
+         "write is read through the other descriptor");
+  close (fd);
+
+  for (i = 0; i < FILE_CNT; i++)
+    close (fds[i]);
+  msg ("closed %d files", FILE_CNT);
+
+  for (i = FILE_CNT - 1; i >= 0; i--)
+    {
+      snprintf (name, sizeof name, "file%d", i);
+      if ((fds[i] = open (name)) < 2)
+        fail ("reopen \"%s\" failed", name);
+      if (read (fds[i], buf, sizeof buf) != sizeof buf
+          || strcmp (buf, i == 7 ? "shared" : name))
+        fail ("\"%s\" reported bad data after reopening", name);
+    }
+  msg ("reopened %d files", FILE_CNT);
+
+  CHECK (remove ("file3"), "remove \"file3\"");
+  CHECK (open ("file3") == -1, "open removed \"file3\" fails");
+  seek (fds[3], 0);
+  CHECK (read (fds[3], buf, sizeof buf) == sizeof buf
+         && !strcmp (buf, "file3"), "removed \"file3\" is still readable");
+  for (i = 0; i < FILE_CNT; i++)
+    close (fds[i]);
+}
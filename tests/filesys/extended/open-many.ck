@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(open-many) begin
+(open-many) opened and wrote 20 files
+(open-many) open "file7" again
+(open-many) second open gets a new descriptor
+(open-many) write "shared" to "file7"
+(open-many) write is read through the other descriptor
+(open-many) closed 20 files
+(open-many) reopened 20 files
+(open-many) remove "file3"
+(open-many) open removed "file3" fails
+(open-many) removed "file3" is still readable
+(open-many) end
+EOF
+pass;
@@ -0,0 +1,53 @@
+/* Writes a large file, then reads it back in blocks of random length
+   at random offsets, including blocks that run past the end of the
+   file, and checks every byte. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE 300000
+#define READ_CNT 500
+#define MAX_BLOCK 2000
+
+static char buf[FILE_SIZE];
+static char block[MAX_BLOCK];
+
+void
+test_main (void)
+{
+  int fd, i;
+
+  random_init (0);
+  random_bytes (buf, sizeof buf);
+
+  CHECK (create ("random", 0), "create \"random\"");
+  CHECK ((fd = open ("random")) > 1, "open \"random\"");
+  CHECK (write (fd, buf, sizeof buf) == FILE_SIZE, "write \"random\"");
+
+  msg ("read \"random\" at random offsets");
+  for (i = 0; i < READ_CNT; i++)
+    {
+      size_t ofs = random_ulong () % FILE_SIZE;
+      size_t size = random_ulong () % MAX_BLOCK + 1;
+      size_t expected = size > FILE_SIZE - ofs ? FILE_SIZE - ofs : size;
+      int ret;
+
+      seek (fd, ofs);
+      ret = read (fd, block, size);
+      if (ret != (int) expected)
+        fail ("read %zu bytes at offset %zu returned %d", size, ofs, ret);
+      if (memcmp (block, buf + ofs, expected))
+        fail ("read %zu bytes at offset %zu reported bad data", size, ofs);
+      if (tell (fd) != ofs + expected)
+        fail ("tell after read at offset %zu returned %u", ofs, tell (fd));
+    }
+
+  seek (fd, FILE_SIZE + 100);
+  CHECK (read (fd, block, 1) == 0, "read past end of file");
+
+  msg ("close \"random\"");
+  close (fd);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(seek-random) begin
+(seek-random) create "random"
+(seek-random) open "random"
+(seek-random) write "random"
+(seek-random) read "random" at random offsets
+(seek-random) read past end of file
+(seek-random) close "random"
+(seek-random) end
+EOF
+pass;
@@ -0,0 +1,79 @@
+/* Scatters the frames of a 4KB-mapped region between page cache
+   frames of a scratch file, then removes the file to leave holes
+   between them. Touching a large region afterward needs 2MB runs, which
+   have to be assembled by moving frames. Checks that every aligned
+   2MB region is physically contiguous and that the data in both
+   regions is intact. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define HUGE_SIZE (2 * 1024 * 1024)
+#define SCATTER_PAGES 128
+#define BIG_SIZE (6 * 1024 * 1024)
+
+static char scatter[SCATTER_PAGES * PAGE_SIZE];
+static char big[BIG_SIZE];
+
+static char
+value (size_t i)
+{
+  return (char) (i * 13 + 1);
+}
+
+void
+test_main (void)
+{
+  char *map = (char *) 0x10000000;
+  char *base, *end, *p;
+  int handle;
+  size_t i;
+
+  /* A page mapped to the zero frame keeps the region out of 2MB
+     pages, so the writes below get 4KB frames. */
+  for (i = 0; i < SCATTER_PAGES; i++)
+    if (scatter[i * PAGE_SIZE] != 0)
+      fail ("scatter page %zu is not zero", i);
+
+  CHECK (create ("scratch", SCATTER_PAGES * PAGE_SIZE), "create \"scratch\"");
+  CHECK ((handle = open ("scratch")) > 1, "open \"scratch\"");
+  CHECK (mmap (map, SCATTER_PAGES * PAGE_SIZE, 0, handle, 0) != MAP_FAILED,
+         "mmap \"scratch\"");
+  for (i = 0; i < SCATTER_PAGES; i++)
+    {
+      if (map[i * PAGE_SIZE] != 0)
+        fail ("scratch page %zu is not zero", i);
+      scatter[i * PAGE_SIZE] = value (i);
+    }
+  munmap (map);
+  close (handle);
+  CHECK (remove ("scratch"), "remove \"scratch\"");
+
+  for (i = 0; i < BIG_SIZE; i += PAGE_SIZE)
+    big[i] = value (i / PAGE_SIZE);
+
+  base = (char *) (((uintptr_t) big + HUGE_SIZE - 1) & ~(uintptr_t) (HUGE_SIZE - 1));
+  end = big + BIG_SIZE;
+  for (; base + HUGE_SIZE <= end; base += HUGE_SIZE)
+    {
+      char *pa = get_phys_addr (base);
+      if ((uintptr_t) pa % HUGE_SIZE != 0)
+        fail ("region at %p is not 2MB aligned", base);
+      for (p = base; p < base + HUGE_SIZE; p += PAGE_SIZE)
+        if (get_phys_addr (p) != pa + (p - base))
+          fail ("region at %p is not contiguous", base);
+    }
+  msg ("aligned regions are contiguous");
+
+  for (i = 0; i < BIG_SIZE; i += PAGE_SIZE)
+    if (big[i] != value (i / PAGE_SIZE))
+      fail ("big page %zu is inconsistent", i / PAGE_SIZE);
+  for (i = 0; i < SCATTER_PAGES; i++)
+    if (scatter[i * PAGE_SIZE] != value (i))
+      fail ("scatter page %zu is inconsistent", i);
+  msg ("data is consistent");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(compact-huge) begin
+(compact-huge) create "scratch"
+(compact-huge) open "scratch"
+(compact-huge) mmap "scratch"
+(compact-huge) remove "scratch"
+(compact-huge) aligned regions are contiguous
+(compact-huge) data is consistent
+(compact-huge) end
+EOF
+pass;
@@ -0,0 +1,72 @@
+/* Maps part of a large file and checks every page against read()
+   while touching the pages forward, backward and with a stride, so
+   that pages mapped ahead of a fault and pages faulted one by one are
+   both checked. Also checks initialized data that spans several pages
+   of the executable. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 64
+#define MAP_SIZE (PAGE_COUNT * PAGE_SIZE)
+
+static char expected[MAP_SIZE];
+
+/* Lives in the data segment, one marker per page. */
+static char data_pages[4 * PAGE_SIZE] = {
+  [0] = 'a', [PAGE_SIZE] = 'b', [2 * PAGE_SIZE] = 'c', [3 * PAGE_SIZE] = 'd',
+};
+
+static void
+check_page (const char *actual, size_t i)
+{
+  if (memcmp (actual + i * PAGE_SIZE, expected + i * PAGE_SIZE, PAGE_SIZE))
+    fail ("page %zu of mmap'd file reported bad data", i);
+}
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  int handle;
+  void *map;
+  size_t i;
+
+  CHECK ((handle = open ("large.txt")) > 1, "open \"large.txt\"");
+  CHECK (read (handle, expected, MAP_SIZE) == MAP_SIZE, "read \"large.txt\"");
+
+  CHECK ((map = mmap (actual, MAP_SIZE, 0, handle, 0)) != MAP_FAILED,
+         "mmap \"large.txt\"");
+  for (i = 0; i < PAGE_COUNT; i++)
+    check_page (actual, i);
+  msg ("forward touch matches");
+  munmap (map);
+
+  CHECK ((map = mmap (actual, MAP_SIZE, 0, handle, 0)) != MAP_FAILED,
+         "mmap \"large.txt\" again");
+  for (i = PAGE_COUNT; i-- > 0; )
+    check_page (actual, i);
+  msg ("backward touch matches");
+  munmap (map);
+
+  CHECK ((map = mmap (actual, MAP_SIZE, 0, handle, 0)) != MAP_FAILED,
+         "mmap \"large.txt\" again");
+  for (i = 0; i < PAGE_COUNT; i++)
+    check_page (actual, i * 7 % PAGE_COUNT);
+  msg ("strided touch matches");
+  munmap (map);
+  close (handle);
+
+  for (i = 0; i < 4; i++)
+    if (data_pages[i * PAGE_SIZE] != 'a' + (int) i)
+      fail ("data page %zu has value %c", i, data_pages[i * PAGE_SIZE]);
+  for (i = 0; i < 4; i++)
+    data_pages[i * PAGE_SIZE + 1] = 'A' + i;
+  for (i = 0; i < 4; i++)
+    if (data_pages[i * PAGE_SIZE + 1] != 'A' + (int) i)
+      fail ("write to data page %zu was lost", i);
+  msg ("data segment is intact and writable");
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fault-around) begin
+(fault-around) open "large.txt"
+(fault-around) read "large.txt"
+(fault-around) mmap "large.txt"
+(fault-around) forward touch matches
+(fault-around) mmap "large.txt" again
+(fault-around) backward touch matches
+(fault-around) mmap "large.txt" again
+(fault-around) strided touch matches
+(fault-around) data segment is intact and writable
+(fault-around) end
+EOF
+pass;
@@ -0,0 +1,73 @@
+/* Grows the stack and faults in a mapped file, and checks that the
+   fault latency counters read through interrupt 0x45 count both kinds
+   of fault. Also checks that out-of-range queries fail. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Kinds and indexes understood by interrupt 0x45. */
+#define KIND_STACK 1
+#define KIND_FILE 2
+#define KIND_CNT 5
+#define IDX_COUNT 40
+#define IDX_CYCLES 41
+
+#define STACK_PAGES 16
+
+static long long
+faultstat (long long kind, long long idx)
+{
+  long long ret;
+
+  asm volatile ("movq %1, %%rax; movq %2, %%rdx; int $0x45; movq %%rax, %0"
+                : "=r" (ret)
+                : "r" (kind), "r" (idx)
+                : "rax", "rdx", "memory");
+  return ret;
+}
+
+static void __attribute__ ((noinline))
+grow_stack (void)
+{
+  volatile char buf[STACK_PAGES * 4096];
+  size_t i;
+
+  for (i = 0; i < sizeof buf; i += 4096)
+    buf[sizeof buf - 1 - i] = i;
+}
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  long long stack_cnt, file_cnt, file_cycles;
+  int handle;
+  void *map;
+
+  CHECK (faultstat (KIND_CNT, IDX_COUNT) == -1, "unknown kind is rejected");
+  CHECK (faultstat (KIND_FILE, IDX_CYCLES + 1) == -1,
+         "unknown index is rejected");
+
+  stack_cnt = faultstat (KIND_STACK, IDX_COUNT);
+  grow_stack ();
+  CHECK (faultstat (KIND_STACK, IDX_COUNT) > stack_cnt,
+         "stack growth is counted");
+
+  file_cnt = faultstat (KIND_FILE, IDX_COUNT);
+  file_cycles = faultstat (KIND_FILE, IDX_CYCLES);
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap (actual, 4096, 0, handle, 0)) != MAP_FAILED,
+         "mmap \"sample.txt\"");
+  if (memcmp (actual, sample, strlen (sample)))
+    fail ("read of mmap'd file reported bad data");
+  CHECK (faultstat (KIND_FILE, IDX_COUNT) > file_cnt,
+         "file fault is counted");
+  CHECK (faultstat (KIND_FILE, IDX_CYCLES) > file_cycles,
+         "file fault time is counted");
+
+  munmap (map);
+  close (handle);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(faultstat) begin
+(faultstat) unknown kind is rejected
+(faultstat) unknown index is rejected
+(faultstat) stack growth is counted
+(faultstat) open "sample.txt"
+(faultstat) mmap "sample.txt"
+(faultstat) file fault is counted
+(faultstat) file fault time is counted
+(faultstat) end
+EOF
+pass;
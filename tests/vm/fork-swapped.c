@@ -0,0 +1,77 @@
+/* Forks a process whose anonymous pages have been pushed out of
+   memory, some to the swap disk, some compressed in memory and some
+   kept only as the byte they are filled with, and checks that the
+   child and the parent still see the same contents.
+   For this test, Pintos memory size is 10MB. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1 << PAGE_SHIFT)
+#define ONE_MB (1 << 20) // 1MB
+#define CHUNK_SIZE (8*ONE_MB)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+static char big_chunks[CHUNK_SIZE];
+
+/* Byte J of page I. Every third page is filled with one nonzero
+   byte, every third is almost all zeros and the rest is noise that
+   does not compress. */
+static char
+expected (size_t i, size_t j)
+{
+  switch (i % 3)
+    {
+    case 0:
+      return (char) (i | 1);
+    case 1:
+      return j == 0 ? (char) i : j == PAGE_SIZE - 1 ? (char) ~i : 0;
+    default:
+      return (char) ((i * 2654435761u + j * 40503u) >> 7);
+    }
+}
+
+static void
+fill (void)
+{
+  size_t i, j;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    for (j = 0; j < PAGE_SIZE; j++)
+      big_chunks[i * PAGE_SIZE + j] = expected (i, j);
+}
+
+static void
+verify (void)
+{
+  size_t i, j;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    for (j = 0; j < PAGE_SIZE; j++)
+      if (big_chunks[i * PAGE_SIZE + j] != expected (i, j))
+        fail ("byte %zu of page %zu is inconsistent", j, i);
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+
+  msg ("fill pages");
+  fill ();
+
+  child = fork ("child");
+  if (child == 0)
+    {
+      verify ();
+      exit (0);
+    }
+  CHECK (child > 0, "fork");
+  CHECK (wait (child) == 0, "wait for child");
+  verify ();
+  msg ("parent pages are intact");
+}
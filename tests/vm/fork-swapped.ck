@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fork-swapped) begin
+(fork-swapped) fill pages
+(fork-swapped) fork
+(fork-swapped) wait for child
+(fork-swapped) parent pages are intact
+(fork-swapped) end
+EOF
+pass;
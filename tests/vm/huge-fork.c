@@ -0,0 +1,73 @@
+/* Writes a region large enough to hold an aligned 2MB page and
+   checks that it is mapped physically contiguous. Then forks: the
+   child checks and overwrites its copy, and the parent checks that its
+   own data did not change. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define HUGE_SIZE (2 * 1024 * 1024)
+#define BIG_SIZE (4 * 1024 * 1024)
+
+static char big[BIG_SIZE];
+
+static char
+value (size_t i)
+{
+  return (char) (i * 17 + 3);
+}
+
+static void
+check_big (const char *who)
+{
+  size_t i;
+
+  for (i = 0; i < BIG_SIZE; i += PAGE_SIZE)
+    if (big[i] != value (i / PAGE_SIZE)
+        || big[i + PAGE_SIZE - 1] != ~value (i / PAGE_SIZE))
+      fail ("page %zu is inconsistent in %s", i / PAGE_SIZE, who);
+}
+
+void
+test_main (void)
+{
+  char *base, *pa, *p;
+  size_t i;
+  pid_t child;
+
+  for (i = 0; i < BIG_SIZE; i += PAGE_SIZE)
+    {
+      big[i] = value (i / PAGE_SIZE);
+      big[i + PAGE_SIZE - 1] = ~value (i / PAGE_SIZE);
+    }
+
+  base = (char *) (((uintptr_t) big + HUGE_SIZE - 1) & ~(uintptr_t) (HUGE_SIZE - 1));
+  for (; base + HUGE_SIZE <= big + BIG_SIZE; base += HUGE_SIZE)
+    {
+      pa = get_phys_addr (base);
+      if ((uintptr_t) pa % HUGE_SIZE != 0)
+        fail ("region at %p is not 2MB aligned", base);
+      for (p = base; p < base + HUGE_SIZE; p += PAGE_SIZE)
+        if (get_phys_addr (p) != pa + (p - base))
+          fail ("region at %p is not contiguous", base);
+    }
+  msg ("aligned regions are contiguous");
+  check_big ("parent");
+  msg ("parent data is consistent");
+
+  child = fork ("child");
+  if (child == 0)
+    {
+      check_big ("child");
+      msg ("child data is consistent");
+      memset (big, 0xa5, BIG_SIZE);
+      exit (0);
+    }
+  CHECK (wait (child) == 0, "wait for child");
+  check_big ("parent");
+  msg ("parent data is unchanged");
+}
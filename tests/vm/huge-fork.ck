@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(huge-fork) begin
+(huge-fork) aligned regions are contiguous
+(huge-fork) parent data is consistent
+(huge-fork) child data is consistent
+(huge-fork) wait for child
+(huge-fork) parent data is unchanged
+(huge-fork) end
+EOF
+pass;
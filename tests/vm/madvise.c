@@ -0,0 +1,62 @@
+/* Gives every kind of advice on a file mapping and on anonymous
+   memory and checks that the contents stay correct. Advice that
+   drops pages must make anonymous memory read back as zeros. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+static char anon[4 * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  int handle;
+  void *map;
+  size_t i;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap (actual, PAGE_SIZE, 0, handle, 0)) != MAP_FAILED,
+         "mmap \"sample.txt\"");
+
+  CHECK (madvise (NULL, PAGE_SIZE, MADV_NORMAL) == -1,
+         "reject null address");
+  CHECK (madvise (actual + 1, PAGE_SIZE, MADV_NORMAL) == -1,
+         "reject misaligned address");
+  CHECK (madvise (actual, PAGE_SIZE, 99) == -1, "reject unknown advice");
+
+  /* The mapping has not been touched yet, so nothing is loaded. */
+  CHECK (madvise (actual, PAGE_SIZE, MADV_WILLNEED) == 0,
+         "MADV_WILLNEED on mapping");
+  if (memcmp (actual, sample, strlen (sample)))
+    fail ("read of prefetched mapping reported bad data");
+  for (i = strlen (sample); i < PAGE_SIZE; i++)
+    if (actual[i] != 0)
+      fail ("byte %zu of mapping has value %02hhx (should be 0)",
+            i, actual[i]);
+
+  CHECK (madvise (actual, PAGE_SIZE, MADV_SEQUENTIAL) == 0,
+         "MADV_SEQUENTIAL on mapping");
+  CHECK (madvise (actual, PAGE_SIZE, MADV_RANDOM) == 0,
+         "MADV_RANDOM on mapping");
+  CHECK (madvise (actual, PAGE_SIZE, MADV_NORMAL) == 0,
+         "MADV_NORMAL on mapping");
+  if (memcmp (actual, sample, strlen (sample)))
+    fail ("read of mapping reported bad data");
+
+  memset (anon, 'x', sizeof anon);
+  CHECK (madvise (anon, sizeof anon, MADV_DONTNEED) == 0,
+         "MADV_DONTNEED on anonymous pages");
+  for (i = 0; i < sizeof anon; i++)
+    if (anon[i] != 0)
+      fail ("byte %zu of dropped page has value %02hhx (should be 0)",
+            i, anon[i]);
+
+  munmap (map);
+  close (handle);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise) begin
+(madvise) open "sample.txt"
+(madvise) mmap "sample.txt"
+(madvise) reject null address
+(madvise) reject misaligned address
+(madvise) reject unknown advice
+(madvise) MADV_WILLNEED on mapping
+(madvise) MADV_SEQUENTIAL on mapping
+(madvise) MADV_RANDOM on mapping
+(madvise) MADV_NORMAL on mapping
+(madvise) MADV_DONTNEED on anonymous pages
+(madvise) end
+EOF
+pass;
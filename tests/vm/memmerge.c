@@ -0,0 +1,73 @@
+/* Fills pages with identical contents so that they can be merged
+   into one shared frame, then writes to some of them, once from user
+   code and once through read(), and checks that only the written
+   pages change. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 32
+
+static char pages[PAGE_COUNT][PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static char data[PAGE_SIZE];
+
+static char
+expected (size_t j)
+{
+  return (char) (j * 7 + 1);
+}
+
+/* Checks that every page except SKIP_A and SKIP_B still holds the
+   contents all of them were filled with. */
+static void
+check_pages (size_t skip_a, size_t skip_b)
+{
+  size_t i, j;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    if (i != skip_a && i != skip_b)
+      for (j = 0; j < PAGE_SIZE; j++)
+        if (pages[i][j] != expected (j))
+          fail ("byte %zu of page %zu is %02hhx, should be %02hhx",
+                j, i, pages[i][j], expected (j));
+}
+
+void
+test_main (void)
+{
+  size_t i, j;
+  int handle;
+
+  CHECK (!memmerge (true), "enable merging");
+  msg ("fill identical pages");
+  for (i = 0; i < PAGE_COUNT; i++)
+    for (j = 0; j < PAGE_SIZE; j++)
+      pages[i][j] = expected (j);
+
+  /* Give the merging thread time to scan the pages twice. */
+  for (i = 0; i < 50; i++)
+    check_pages (PAGE_COUNT, PAGE_COUNT);
+
+  msg ("write to one page");
+  pages[0][100] = 'u';
+  if (pages[0][100] != 'u')
+    fail ("write to page 0 was lost");
+  check_pages (0, PAGE_COUNT);
+
+  memset (data, 'k', sizeof data);
+  CHECK (create ("data", 0), "create \"data\"");
+  CHECK ((handle = open ("data")) > 1, "open \"data\"");
+  CHECK (write (handle, data, sizeof data) == sizeof data, "write \"data\"");
+  seek (handle, 0);
+  CHECK (read (handle, pages[1], PAGE_SIZE) == PAGE_SIZE,
+         "read \"data\" into another page");
+  if (memcmp (pages[1], data, PAGE_SIZE))
+    fail ("read into page 1 was lost");
+  check_pages (0, 1);
+  close (handle);
+
+  CHECK (memmerge (false), "disable merging");
+}
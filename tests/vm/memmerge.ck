@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(memmerge) begin
+(memmerge) enable merging
+(memmerge) fill identical pages
+(memmerge) write to one page
+(memmerge) create "data"
+(memmerge) open "data"
+(memmerge) write "data"
+(memmerge) read "data" into another page
+(memmerge) disable merging
+(memmerge) end
+EOF
+pass;
@@ -0,0 +1,47 @@
+/* Checks that read() and write() on a file and a mapping of it see
+   each other's changes at once, without an munmap in between, and
+   that a mapping of a removed file keeps working. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define FILE_SIZE (2 * PAGE_SIZE)
+
+void
+test_main (void)
+{
+  char *map = (char *) 0x10000000;
+  char buf[16];
+  int handle, fd;
+
+  CHECK (create ("coherent", FILE_SIZE), "create \"coherent\"");
+  CHECK ((handle = open ("coherent")) > 1, "open \"coherent\"");
+  CHECK (mmap (map, FILE_SIZE, 1, handle, 0) != MAP_FAILED,
+         "mmap \"coherent\"");
+  if (map[PAGE_SIZE] != 0)
+    fail ("new file does not read as zeros");
+
+  CHECK ((fd = open ("coherent")) > 1, "open \"coherent\" again");
+  seek (fd, PAGE_SIZE);
+  CHECK (write (fd, "written", 8) == 8, "write \"written\"");
+  CHECK (!strcmp (map + PAGE_SIZE, "written"), "write is visible in mapping");
+
+  strlcpy (map, "stored", 16);
+  seek (fd, 0);
+  CHECK (read (fd, buf, 7) == 7, "read first page");
+  CHECK (!strcmp (buf, "stored"), "store is visible to read");
+
+  close (fd);
+  CHECK (remove ("coherent"), "remove \"coherent\"");
+  CHECK (open ("coherent") == -1, "open removed \"coherent\" fails");
+  CHECK (!strcmp (map, "stored") && !strcmp (map + PAGE_SIZE, "written"),
+         "mapping still reads the data");
+  strlcpy (map + PAGE_SIZE, "again", 16);
+  CHECK (!strcmp (map + PAGE_SIZE, "again"), "mapping is still writable");
+
+  munmap (map);
+  close (handle);
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-coherent) begin
+(mmap-coherent) create "coherent"
+(mmap-coherent) open "coherent"
+(mmap-coherent) mmap "coherent"
+(mmap-coherent) open "coherent" again
+(mmap-coherent) write "written"
+(mmap-coherent) write is visible in mapping
+(mmap-coherent) read first page
+(mmap-coherent) store is visible to read
+(mmap-coherent) remove "coherent"
+(mmap-coherent) open removed "coherent" fails
+(mmap-coherent) mapping still reads the data
+(mmap-coherent) mapping is still writable
+(mmap-coherent) end
+EOF
+pass;
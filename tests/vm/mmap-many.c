@@ -0,0 +1,72 @@
+/* Maps one file at many places at once, unmaps every other mapping
+   and maps those places again, checking the data each time. Then maps
+   1 GB of the file, which is mostly past its end, and touches only its
+   first and last pages. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define MAP_CNT 100
+#define MAP_BASE ((char *) 0x10000000)
+#define MAP_GAP 0x10000
+#define HUGE_BASE ((char *) 0x100000000)
+#define HUGE_SIZE (1024 * 1024 * 1024)
+
+static char *
+map_addr (int i)
+{
+  return MAP_BASE + i * MAP_GAP;
+}
+
+static void
+check_maps (int step)
+{
+  int i;
+
+  for (i = 0; i < MAP_CNT; i += step)
+    if (memcmp (map_addr (i), sample, strlen (sample)))
+      fail ("mapping %d reported bad data", i);
+}
+
+void
+test_main (void)
+{
+  int handle;
+  int i;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  for (i = 0; i < MAP_CNT; i++)
+    if (mmap (map_addr (i), PAGE_SIZE, 0, handle, 0) != map_addr (i))
+      fail ("mmap %d failed", i);
+  check_maps (1);
+  msg ("%d mappings read back", MAP_CNT);
+
+  CHECK (mmap (map_addr (7), PAGE_SIZE, 0, handle, 0) == MAP_FAILED,
+         "overlapping mmap is rejected");
+
+  for (i = 0; i < MAP_CNT; i += 2)
+    munmap (map_addr (i));
+  check_maps (2);
+  for (i = 0; i < MAP_CNT; i += 2)
+    if (mmap (map_addr (i), PAGE_SIZE, 0, handle, 0) != map_addr (i))
+      fail ("mmap %d again failed", i);
+  check_maps (1);
+  msg ("unmapped places mapped again");
+  for (i = 0; i < MAP_CNT; i++)
+    munmap (map_addr (i));
+
+  CHECK (mmap (HUGE_BASE, HUGE_SIZE, 0, handle, 0) == HUGE_BASE,
+         "mmap 1 GB of \"sample.txt\"");
+  if (memcmp (HUGE_BASE, sample, strlen (sample)))
+    fail ("first page of the 1 GB mapping reported bad data");
+  for (i = 0; i < PAGE_SIZE; i++)
+    if (HUGE_BASE[HUGE_SIZE - PAGE_SIZE + i] != 0)
+      fail ("byte %d of the last page is not zero", i);
+  msg ("first and last pages of the 1 GB mapping are right");
+  munmap (HUGE_BASE);
+  close (handle);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-many) begin
+(mmap-many) open "sample.txt"
+(mmap-many) 100 mappings read back
+(mmap-many) overlapping mmap is rejected
+(mmap-many) unmapped places mapped again
+(mmap-many) mmap 1 GB of "sample.txt"
+(mmap-many) first and last pages of the 1 GB mapping are right
+(mmap-many) end
+EOF
+pass;
@@ -0,0 +1,56 @@
+/* Two processes map the same file and check that each sees the
+   other's stores at once, without an munmap in between, and that
+   read() sees the stores too. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define FILE_SIZE (2 * PAGE_SIZE)
+
+void
+test_main (void)
+{
+  char *parent_map = (char *) 0x10000000;
+  char *child_map = (char *) 0x20000000;
+  char buf[16];
+  int handle;
+  pid_t pid;
+
+  CHECK (create ("shared", FILE_SIZE), "create \"shared\"");
+  CHECK ((handle = open ("shared")) > 1, "open \"shared\"");
+  CHECK (mmap (parent_map, FILE_SIZE, 1, handle, 0) != MAP_FAILED,
+         "mmap \"shared\"");
+  strlcpy (parent_map, "parent", 16);
+
+  if ((pid = fork ("child")) == 0)
+    {
+      int fd = open ("shared");
+      if (fd < 2 || mmap (child_map, FILE_SIZE, 1, fd, 0) == MAP_FAILED)
+        exit (1);
+      if (strcmp (child_map, "parent"))
+        exit (2);
+      strlcpy (child_map + PAGE_SIZE, "child", 16);
+      munmap (child_map);
+      close (fd);
+      exit (0);
+    }
+  CHECK (wait (pid) == 0, "child saw the parent's store");
+  if (strcmp (parent_map + PAGE_SIZE, "child"))
+    fail ("parent's mapping does not show the child's store");
+  msg ("parent saw the child's store");
+
+  seek (handle, 0);
+  CHECK (read (handle, buf, sizeof buf) == sizeof buf, "read first page");
+  if (strcmp (buf, "parent"))
+    fail ("read() does not show the parent's store");
+  seek (handle, PAGE_SIZE);
+  CHECK (read (handle, buf, sizeof buf) == sizeof buf, "read second page");
+  if (strcmp (buf, "child"))
+    fail ("read() does not show the child's store");
+
+  munmap (parent_map);
+  close (handle);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-shared) begin
+(mmap-shared) create "shared"
+(mmap-shared) open "shared"
+(mmap-shared) mmap "shared"
+(mmap-shared) child saw the parent's store
+(mmap-shared) parent saw the child's store
+(mmap-shared) read first page
+(mmap-shared) read second page
+(mmap-shared) end
+EOF
+pass;
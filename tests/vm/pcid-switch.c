@@ -0,0 +1,78 @@
+/* Switches back and forth between a parent and children that write
+   different values at the same virtual address, and maps two files
+   one after the other at the same address. Stale TLB entries, kept
+   across a switch or an munmap, would show the wrong data. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/vm/small.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHILD_CNT 8
+
+static int page[PAGE_SIZE / sizeof (int)];
+
+static void
+fill (int value)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_SIZE / sizeof (int); i++)
+    page[i] = value;
+}
+
+static bool
+filled (int value)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_SIZE / sizeof (int); i++)
+    if (page[i] != value)
+      return false;
+  return true;
+}
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  int handle;
+  int i;
+
+  fill (-1);
+  for (i = 0; i < CHILD_CNT; i++)
+    {
+      pid_t pid = fork ("child");
+      if (pid == 0)
+        {
+          if (!filled (-1))
+            exit (-1);
+          fill (i);
+          exit (filled (i) ? i : -1);
+        }
+      if (wait (pid) != i)
+        fail ("child %d saw the wrong data", i);
+      if (!filled (-1))
+        fail ("parent sees child %d's data", i);
+    }
+  msg ("parent and %d children kept their own data", CHILD_CNT);
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (actual, PAGE_SIZE, 0, handle, 0) != MAP_FAILED,
+         "mmap \"sample.txt\"");
+  if (memcmp (actual, sample, strlen (sample)))
+    fail ("read of mmap'd \"sample.txt\" reported bad data");
+  munmap (actual);
+  close (handle);
+
+  CHECK ((handle = open ("small.txt")) > 1, "open \"small.txt\"");
+  CHECK (mmap (actual, PAGE_SIZE, 0, handle, 0) != MAP_FAILED,
+         "mmap \"small.txt\" at the same address");
+  if (memcmp (actual, small, PAGE_SIZE))
+    fail ("read of mmap'd \"small.txt\" reported bad data");
+  munmap (actual);
+  close (handle);
+}
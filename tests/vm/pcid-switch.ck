@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(pcid-switch) begin
+(pcid-switch) parent and 8 children kept their own data
+(pcid-switch) open "sample.txt"
+(pcid-switch) mmap "sample.txt"
+(pcid-switch) open "small.txt"
+(pcid-switch) mmap "small.txt" at the same address
+(pcid-switch) end
+EOF
+pass;
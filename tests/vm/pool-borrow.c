@@ -0,0 +1,76 @@
+/* Has a child write more data than the user pool holds while the swap
+   disk is too small to take the rest, so the user pool has to borrow
+   pages from the kernel pool. The data is pseudo-random so that it
+   does not compress. Once the child exits, the parent forks more
+   children and opens files, which needs the kernel pool pages back. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ONE_MB (1 << 20) // 1MB
+#define CHUNK_SIZE (12*ONE_MB)
+#define WORD_COUNT (CHUNK_SIZE / sizeof (uint64_t))
+#define CHILD_CNT 8
+#define FILE_CNT 16
+
+static uint64_t big_chunks[WORD_COUNT];
+
+static uint64_t
+next (uint64_t x)
+{
+  return x * 6364136223846793005ULL + 1442695040888963407ULL;
+}
+
+static int
+fill_and_check (void)
+{
+  uint64_t x = 1;
+  size_t i;
+
+  for (i = 0; i < WORD_COUNT; i++)
+    big_chunks[i] = x = next (x);
+  x = 1;
+  for (i = 0; i < WORD_COUNT; i++)
+    {
+      x = next (x);
+      if (big_chunks[i] != x)
+        fail ("word %zu is inconsistent", i);
+    }
+  return 0x42;
+}
+
+void
+test_main (void)
+{
+  int fds[FILE_CNT];
+  pid_t child;
+  int i;
+
+  child = fork ("filler");
+  if (child == 0)
+    exit (fill_and_check ());
+  CHECK (wait (child) == 0x42, "wait for filler");
+
+  for (i = 0; i < CHILD_CNT; i++)
+    {
+      child = fork ("child");
+      if (child == 0)
+        exit (i);
+      if (child < 0)
+        fail ("fork %d failed", i);
+      if (wait (child) != i)
+        fail ("child %d exited with the wrong status", i);
+    }
+  msg ("forked %d children", CHILD_CNT);
+
+  CHECK (create ("borrow", 512), "create \"borrow\"");
+  for (i = 0; i < FILE_CNT; i++)
+    if ((fds[i] = open ("borrow")) < 2)
+      fail ("open %d failed", i);
+  for (i = 0; i < FILE_CNT; i++)
+    close (fds[i]);
+  msg ("opened \"borrow\" %d times", FILE_CNT);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(pool-borrow) begin
+(pool-borrow) wait for filler
+(pool-borrow) forked 8 children
+(pool-borrow) create "borrow"
+(pool-borrow) opened "borrow" 16 times
+(pool-borrow) end
+EOF
+pass;
@@ -0,0 +1,59 @@
+/* Caps the number of frames the process may hold below the size of
+   its working set and checks that its pages survive being evicted
+   to stay under the cap, both while writing them and when the cap is
+   lowered after they are all resident. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1 << PAGE_SHIFT)
+#define ONE_MB (1 << 20) // 1MB
+#define CHUNK_SIZE (1*ONE_MB)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+static char big_chunks[CHUNK_SIZE];
+
+static void
+write_pages (void)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    {
+      big_chunks[i * PAGE_SIZE] = (char) i;
+      big_chunks[i * PAGE_SIZE + PAGE_SIZE - 1] = (char) ~i;
+    }
+}
+
+static void
+check_pages (void)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    if (big_chunks[i * PAGE_SIZE] != (char) i
+        || big_chunks[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) ~i)
+      fail ("data in page %zu is inconsistent", i);
+}
+
+void
+test_main (void)
+{
+  CHECK (rsslimit (64) == 0, "limit to 64 frames");
+  write_pages ();
+  check_pages ();
+  msg ("pages are intact under the limit");
+
+  CHECK (rsslimit (0) == 64, "remove the limit");
+  check_pages ();
+  msg ("pages are intact without a limit");
+
+  CHECK (rsslimit (16) == 0, "lower the limit to 16 frames");
+  check_pages ();
+  msg ("pages are intact after lowering the limit");
+  CHECK (rsslimit (0) == 16, "remove the limit");
+}
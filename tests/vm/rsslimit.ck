@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(rsslimit) begin
+(rsslimit) limit to 64 frames
+(rsslimit) pages are intact under the limit
+(rsslimit) remove the limit
+(rsslimit) pages are intact without a limit
+(rsslimit) lower the limit to 16 frames
+(rsslimit) pages are intact after lowering the limit
+(rsslimit) remove the limit
+(rsslimit) end
+EOF
+pass;
@@ -0,0 +1,59 @@
+/* Streams through a cold region larger than memory while touching a
+   small hot region between every few cold pages, then checks the data
+   in both. Meant to run with the generational eviction policy, which
+   has to keep ageing the hot pages while the cold ones go to swap. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1 << PAGE_SHIFT)
+#define ONE_MB (1 << 20) // 1MB
+#define HOT_SIZE (ONE_MB)
+#define COLD_SIZE (12*ONE_MB)
+#define HOT_PAGES (HOT_SIZE / PAGE_SIZE)
+#define COLD_PAGES (COLD_SIZE / PAGE_SIZE)
+#define PASS_COUNT 2
+
+static char hot[HOT_SIZE];
+static char cold[COLD_SIZE];
+
+static char
+value (size_t i, int pass)
+{
+  return (char) (i * 7 + pass);
+}
+
+void
+test_main (void)
+{
+  size_t i, h;
+  int pass;
+
+  for (i = 0; i < HOT_PAGES; i++)
+    hot[i * PAGE_SIZE] = value (i, 0);
+
+  h = 0;
+  for (pass = 0; pass < PASS_COUNT; pass++)
+    {
+      for (i = 0; i < COLD_PAGES; i++)
+        {
+          cold[i * PAGE_SIZE] = value (i, pass);
+          if (hot[h * PAGE_SIZE] != value (h, 0))
+            fail ("hot page %zu is inconsistent", h);
+          h = (h + 1) % HOT_PAGES;
+        }
+      for (i = 0; i < COLD_PAGES; i++)
+        if (cold[i * PAGE_SIZE] != value (i, pass))
+          fail ("cold page %zu is inconsistent after pass %d", i, pass);
+      msg ("pass %d is consistent", pass);
+    }
+
+  for (i = 0; i < HOT_PAGES; i++)
+    if (hot[i * PAGE_SIZE] != value (i, 0))
+      fail ("hot page %zu is inconsistent", i);
+  msg ("hot pages are consistent");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-hotcold) begin
+(swap-hotcold) pass 0 is consistent
+(swap-hotcold) pass 1 is consistent
+(swap-hotcold) hot pages are consistent
+(swap-hotcold) end
+EOF
+pass;
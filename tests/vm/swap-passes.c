@@ -0,0 +1,46 @@
+/* Rewrites every page of a region larger than memory several times,
+   checking all of them after each pass. Each pass dirties pages that
+   are already on the swap disk, so pages have to be written out again
+   while others are being read back in. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1 << PAGE_SHIFT)
+#define ONE_MB (1 << 20) // 1MB
+#define CHUNK_SIZE (16*ONE_MB)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+#define PASS_COUNT 3
+
+static char big_chunks[CHUNK_SIZE];
+
+static char
+value (size_t i, int pass)
+{
+  return (char) (i * 31 + pass);
+}
+
+void
+test_main (void)
+{
+  size_t i;
+  int pass;
+
+  for (pass = 0; pass < PASS_COUNT; pass++)
+    {
+      for (i = 0; i < PAGE_COUNT; i++)
+        {
+          big_chunks[i * PAGE_SIZE] = value (i, pass);
+          big_chunks[i * PAGE_SIZE + PAGE_SIZE - 1] = ~value (i, pass);
+        }
+      for (i = 0; i < PAGE_COUNT; i++)
+        if (big_chunks[i * PAGE_SIZE] != value (i, pass)
+            || big_chunks[i * PAGE_SIZE + PAGE_SIZE - 1] != ~value (i, pass))
+          fail ("data in page %zu is inconsistent after pass %d", i, pass);
+      msg ("pass %d is consistent", pass);
+    }
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-passes) begin
+(swap-passes) pass 0 is consistent
+(swap-passes) pass 1 is consistent
+(swap-passes) pass 2 is consistent
+(swap-passes) end
+EOF
+pass;
@@ -0,0 +1,77 @@
+/* Fills most pages of a region larger than memory with a single
+   repeated 8-byte word, either zero or a per-page pattern, and the
+   rest with varied bytes, then checks every byte of every page after
+   they have all been swapped out and back in. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1 << PAGE_SHIFT)
+#define ONE_MB (1 << 20) // 1MB
+#define CHUNK_SIZE (16*ONE_MB)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+static uint64_t big_chunks[CHUNK_SIZE / sizeof (uint64_t)];
+
+/* Returns word J of page I. Two pages in three are same-filled:
+   all zero or one repeated word. */
+static uint64_t
+word_at (size_t i, size_t j)
+{
+  switch (i % 3)
+    {
+    case 0:
+      return 0;
+    case 1:
+      return 0x0101010101010101ULL * (i % 255 + 1);
+    default:
+      return i + j;
+    }
+}
+
+static void
+write_page (size_t i)
+{
+  uint64_t *page = big_chunks + i * (PAGE_SIZE / sizeof (uint64_t));
+  size_t j;
+
+  for (j = 0; j < PAGE_SIZE / sizeof (uint64_t); j++)
+    page[j] = word_at (i, j);
+}
+
+static void
+check_page (size_t i)
+{
+  uint64_t *page = big_chunks + i * (PAGE_SIZE / sizeof (uint64_t));
+  size_t j;
+
+  for (j = 0; j < PAGE_SIZE / sizeof (uint64_t); j++)
+    if (page[j] != word_at (i, j))
+      fail ("word %zu of page %zu is inconsistent", j, i);
+}
+
+void
+test_main (void)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    write_page (i);
+  msg ("wrote %d pages", PAGE_COUNT);
+
+  for (i = 0; i < PAGE_COUNT; i++)
+    check_page (i);
+  msg ("pages are intact after swapping");
+
+  /* A same-filled page that was swapped in must still be writable. */
+  for (i = 0; i < PAGE_COUNT; i += 3)
+    big_chunks[i * (PAGE_SIZE / sizeof (uint64_t)) + 1] = i;
+  for (i = 0; i < PAGE_COUNT; i += 3)
+    if (big_chunks[i * (PAGE_SIZE / sizeof (uint64_t)) + 1] != i)
+      fail ("write to zero-filled page %zu was lost", i);
+  msg ("zero-filled pages are writable again");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-samefill) begin
+(swap-samefill) wrote 4096 pages
+(swap-samefill) pages are intact after swapping
+(swap-samefill) zero-filled pages are writable again
+(swap-samefill) end
+EOF
+pass;
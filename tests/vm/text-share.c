@@ -0,0 +1,48 @@
+/* Runs a second copy of itself and checks that both processes map the
+   same frame for their code, while their writable data stays private.
+   The parent passes the physical addresses of its own pages on the
+   command line and the child reports whether its pages match. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+static int data_page[1024] = { 1 };
+
+static uintptr_t
+parse (const char *s)
+{
+  uintptr_t v = 0;
+
+  for (; *s >= '0' && *s <= '9'; s++)
+    v = v * 10 + (*s - '0');
+  return v;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uintptr_t text_pa = (uintptr_t) get_phys_addr ((void *) main);
+  uintptr_t data_pa;
+  char cmd[64];
+  pid_t pid;
+
+  test_name = "text-share";
+  data_page[0]++;
+  data_pa = (uintptr_t) get_phys_addr (data_page);
+  if (argc == 3)
+    return parse (argv[1]) == text_pa && parse (argv[2]) != data_pa ? 0 : 1;
+
+  msg ("begin");
+  snprintf (cmd, sizeof cmd, "text-share %zu %zu", (size_t) text_pa,
+            (size_t) data_pa);
+  if ((pid = fork ("child")) == 0)
+    {
+      exec (cmd);
+      fail ("exec \"%s\" failed", cmd);
+    }
+  CHECK (wait (pid) == 0, "child shares the text frame but not the data");
+  msg ("end");
+  return 0;
+}
@@ -0,0 +1,46 @@
+/* Reads sparse pages of an untouched BSS region and checks that they
+   read as zeros and all map the same frame. Then writes one of them
+   and checks that only it gets a frame of its own. The first page of
+   the region is skipped, since it may share a page with the data
+   segment. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_COUNT 64
+
+static char bss[PAGE_COUNT * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  void *zero_pa;
+  size_t i;
+
+  for (i = 1; i < PAGE_COUNT; i += 4)
+    if (bss[i * PAGE_SIZE + i] != 0)
+      fail ("byte %zu of page %zu is not zero", i, i);
+  msg ("untouched pages read as zeros");
+
+  zero_pa = get_phys_addr (&bss[PAGE_SIZE]);
+  CHECK (zero_pa != NULL, "first page read is mapped");
+  for (i = 5; i < PAGE_COUNT; i += 4)
+    if (get_phys_addr (&bss[i * PAGE_SIZE]) != zero_pa)
+      fail ("page %zu maps a different frame", i);
+  msg ("read pages share one frame");
+
+  bss[9 * PAGE_SIZE] = 'x';
+  CHECK (get_phys_addr (&bss[9 * PAGE_SIZE]) != zero_pa,
+         "written page has its own frame");
+  CHECK (bss[9 * PAGE_SIZE] == 'x', "write is visible");
+  for (i = 1; i < PAGE_SIZE; i++)
+    if (bss[9 * PAGE_SIZE + i] != 0)
+      fail ("byte %zu of the written page is not zero", i);
+  for (i = 1; i < PAGE_COUNT; i += 4)
+    if (i != 9 && bss[i * PAGE_SIZE] != 0)
+      fail ("write leaked into page %zu", i);
+  msg ("other pages still read as zeros");
+}
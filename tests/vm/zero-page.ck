@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(zero-page) begin
+(zero-page) untouched pages read as zeros
+(zero-page) first page read is mapped
+(zero-page) read pages share one frame
+(zero-page) written page has its own frame
+(zero-page) write is visible
+(zero-page) other pages still read as zeros
+(zero-page) end
+EOF
+pass;
@@ -31,11 +31,17 @@
 #include "tests/threads/tests.h"
 #ifdef VM
 #include "vm/vm.h"
+#include "vm/ksm.h"
+#include "vm/evict.h"
+#include "vm/faultstat.h"
+#include "vm/huge.h"
 #endif
 #ifdef FILESYS
 #include "devices/disk.h"
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
+#include "filesys/buffer_cache.h"
+#include "filesys/dcache.h"
 #endif
 
 /* Page-map-level-4 with kernel mappings only. */
@@ -173,6 +179,7 @@ paging_init (uint64_t mem_end) {
 
 	// reload cr3
 	pml4_activate(0);
+	pcid_init ();
 }
 
 /* Breaks the kernel command line into words and returns them as
@@ -234,6 +241,22 @@ parse_options (char **argv) {
 			user_page_limit = atoi (value);
 		else if (!strcmp (name, "-threads-tests"))
 			thread_tests = true;
+#endif
+#ifdef VM
+		else if (!strcmp (name, "-fa"))
+			fault_around_pages = atoi (value);
+		else if (!strcmp (name, "-rss"))
+			rss_limit_default = atoi (value);
+		else if (!strcmp (name, "-ksm"))
+			ksm_enabled = true;
+		else if (!strcmp (name, "-evict")) {
+			if (value == NULL || !evict_select (value))
+				PANIC ("unknown eviction policy `%s'", value);
+		}
+		else if (!strcmp (name, "-ftrace"))
+			fault_trace = true;
+		else if (!strcmp (name, "-thp"))
+			huge_pages = true;
 #endif
 		else
 			PANIC ("unknown option `%s' (use -h for help)", name);
@@ -336,6 +359,14 @@ usage (void) {
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+			"  -fa=PAGES          Read up to PAGES file pages per page fault.\n"
+			"  -rss=FRAMES        Limit each process to FRAMES resident frames.\n"
+			"  -ksm               Merge identical pages of memmerge() processes.\n"
+			"  -evict=POLICY      Evict frames by POLICY (clock, mglru).\n"
+			"  -ftrace            Print a line for every page fault.\n"
+			"  -thp               Map aligned 2MB anonymous regions with huge pages.\n"
 #endif
 			);
 	power_off ();
@@ -362,12 +393,18 @@ static void
 print_stats (void) {
 	timer_print_stats ();
 	thread_print_stats ();
+	palloc_print_stats ();
 #ifdef FILESYS
 	disk_print_stats ();
+	buffer_cache_print_stats ();
+	dcache_print_stats ();
 #endif
 	console_print_stats ();
 	kbd_print_stats ();
 #ifdef USERPROG
 	exception_print_stats ();
 #endif
+#ifdef VM
+	vm_print_stats ();
+#endif
 }
@@ -2,18 +2,62 @@
 #include <stddef.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "intrinsic.h"
 
+/* PCID-tagged address spaces.
+ *
+ * PCID을 켜면 TLB entry에 CR3 하위 12bit(PCID)가 붙어서 CR3를 바꿔도 다른
+ * 주소 공간의 entry가 남아 있다. 그래서 pml4마다 PCID를 하나씩 주고 CR3의
+ * no-flush bit로 적재하면 process 전환마다 TLB 전체를 비우지 않아도 된다.
+ * PCID는 1부터 순서대로 나눠주고, 다 쓰면 generation을 올리고 TLB 전체를
+ * 비운 뒤 다시 1부터 나눠준다. 이전 generation의 PCID를 가진 pml4는 다음에
+ * 적재될 때 새 PCID를 받는다. PCID 0은 base_pml4와 표에 못 들어간 pml4가
+ * 쓰고, 이 경우는 예전처럼 flush하며 적재한다. */
+#define CR4_PGE (1 << 7)
+#define CR4_PCIDE (1 << 17)
+#define CR3_NOFLUSH (1ULL << 63)
+#define PCID_MASK 0xfff
+#define PCID_CNT 4096				/* 12bit PCID */
+#define PCID_TABLE_SIZE 1024		/* 추적할 수 있는 pml4 수 */
+#define PCID_DEAD ((uint64_t *) 1)	/* 지워진 표 slot */
+
+struct pcid_entry {
+	uint64_t *pml4;		/* NULL: 빈 slot, PCID_DEAD: 지워진 slot */
+	uint32_t gen;		/* pcid를 받은 generation, 0이면 아직 없음 */
+	uint16_t pcid;
+};
+
+static bool pcid_enabled;		/* CPU가 PCID를 지원하고 CR4.PCIDE를 켰음 */
+static bool invpcid_enabled;	/* CPU가 INVPCID를 지원함 */
+static struct pcid_entry pcid_table[PCID_TABLE_SIZE];
+static uint32_t pcid_gen = 1;	/* 현재 generation */
+static uint16_t pcid_next = 1;	/* 다음에 나눠줄 PCID */
+
+static struct pcid_entry *pcid_lookup (uint64_t *pml4);
+static void pcid_track (uint64_t *pml4);
+static void pcid_untrack (uint64_t *pml4);
+static bool pml4_is_active (uint64_t *pml4);
+static void pml4_invalidate (uint64_t *pml4, const void *va);
+static uint64_t *pde_lookup (uint64_t *pml4, const void *va);
+static uint64_t *huge_pde (uint64_t *pml4, const void *va);
+static uint64_t *leaf_walk (uint64_t *pml4, const void *va);
+static bool split_huge (uint64_t *pde);
+
 static uint64_t *
 pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
 	int idx = PDX (va);
 	if (pdp) {
 		uint64_t *pte = (uint64_t *) pdp[idx];
-		if (!((uint64_t) pte & PTE_P)) {
+		if (((uint64_t) pte & (PTE_P | PTE_PS)) == (PTE_P | PTE_PS)) {
+			// 4KB entry 하나를 고치려면 2MB page를 쪼개야 함
+			if (!split_huge (&pdp[idx]))
+				return NULL;
+		} else if (!((uint64_t) pte & PTE_P)) {
 			if (create) {
 				uint64_t *new_page = palloc_get_page (PAL_ZERO);
 				if (new_page)
@@ -95,8 +139,10 @@ pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 uint64_t *
 pml4_create (void) {
 	uint64_t *pml4 = palloc_get_page (0);
-	if (pml4)
+	if (pml4) {
 		memcpy (pml4, base_pml4, PGSIZE);
+		pcid_track (pml4);
+	}
 	return pml4;
 }
 
@@ -122,7 +168,13 @@ pgdir_for_each (uint64_t *pdp, pte_for_each_func *func, void *aux,
 		unsigned pml4_index, unsigned pdp_index) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
+		if ((pdp[i] & (PTE_P | PTE_PS)) == (PTE_P | PTE_PS)) {
+			void *va = (void *) (((uint64_t) pml4_index << PML4SHIFT) |
+								 ((uint64_t) pdp_index << PDPESHIFT) |
+								 ((uint64_t) i << PDXSHIFT));
+			if (!func (&pdp[i], va, aux))
+				return false;
+		} else if (((uint64_t) pte) & PTE_P)
 			if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
 					pml4_index, pdp_index, i))
 				return false;
@@ -143,7 +195,8 @@ pdp_for_each (uint64_t *pdp,
 	return true;
 }
 
-/* Apply FUNC to each available pte entries including kernel's. */
+/* Apply FUNC to each available pte entries including kernel's.
+ * A 2MB mapping is passed once, as its PDE with PTE_PS set. */
 /* 커널을 포함하여 사용 가능한 각 pte 항목에 FUNC를 적용 */
 bool
 pml4_for_each (uint64_t *pml4, pte_for_each_func *func, void *aux) {
@@ -156,6 +209,20 @@ pml4_for_each (uint64_t *pml4, pte_for_each_func *func, void *aux) {
 	return true;
 }
 
+/* Apply FUNC to each present pte of the user part of PML4, in address
+ * order. Unlike pml4_for_each() this skips the kernel mappings that
+ * every pml4 shares. */
+bool
+pml4_for_each_user (uint64_t *pml4, pte_for_each_func *func, void *aux) {
+	for (unsigned i = 0; i < PML4 (KERN_BASE); i++) {
+		uint64_t *pdpe = ptov((uint64_t *) pml4[i]);
+		if (((uint64_t) pdpe) & PTE_P)
+			if (!pdp_for_each ((uint64_t *) PTE_ADDR (pdpe), func, aux, i))
+				return false;
+	}
+	return true;
+}
+
 static void
 pt_destroy (uint64_t *pt) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
@@ -170,6 +237,8 @@ static void
 pgdir_destroy (uint64_t *pdp) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
+		if (pdp[i] & PTE_PS)
+			continue;	// 2MB page의 frame들은 frame table이 돌려준다
 		if (((uint64_t) pte) & PTE_P)
 			pt_destroy (PTE_ADDR (pte));
 	}
@@ -192,6 +261,11 @@ pml4_destroy (uint64_t *pml4) {
 	if (pml4 == NULL)
 		return;
 	ASSERT (pml4 != base_pml4);
+	ASSERT (!pml4_is_active (pml4));
+
+	/* 이 pml4의 PCID는 다음 generation까지 다시 나눠주지 않으므로
+	 * 남은 TLB entry는 flush하지 않아도 된다. */
+	pcid_untrack (pml4);
 
 	/* if PML4 (vaddr) >= 1, it's kernel space by define. */
 	uint64_t *pdpe = ptov ((uint64_t *) pml4[0]);
@@ -201,10 +275,161 @@ pml4_destroy (uint64_t *pml4) {
 }
 
 /* Loads page directory PD into the CPU's page directory base
- * register. */
+ * register. With PCIDs, the TLB entries of PML4 left from its last
+ * activation are kept. */
 void
 pml4_activate (uint64_t *pml4) {
-	lcr3 (vtop (pml4 ? pml4 : base_pml4));
+	if (pml4 == NULL)
+		pml4 = base_pml4;
+	if (!pcid_enabled) {
+		lcr3 (vtop (pml4));
+		return;
+	}
+
+	enum intr_level old_level = intr_disable ();
+	struct pcid_entry *e = pml4 != base_pml4 ? pcid_lookup (pml4) : NULL;
+	if (e == NULL) {
+		// base_pml4는 user 영역이 비어 있어서 PCID 0에 남은 user entry를 쓸 일이 없다
+		lcr3 (vtop (pml4) | (pml4 == base_pml4 ? CR3_NOFLUSH : 0));
+	} else {
+		if (e->gen != pcid_gen) {
+			if (pcid_next == PCID_CNT) {
+				// PCID를 다 썼음: 새 generation을 시작하고 모든 PCID의 entry를 비운다
+				if (invpcid_enabled)
+					invpcid (INVPCID_ALL, 0, 0);
+				else {
+					lcr4 (rcr4 () ^ CR4_PGE);	// CR4.PGE를 바꾸면 TLB 전체가 비워진다
+					lcr4 (rcr4 () ^ CR4_PGE);
+				}
+				pcid_gen++;
+				pcid_next = 1;
+			}
+			// 이번 generation에 처음 나가는 PCID라서 남은 entry가 없다
+			e->pcid = pcid_next++;
+			e->gen = pcid_gen;
+		}
+		lcr3 (vtop (pml4) | e->pcid | CR3_NOFLUSH);
+	}
+	intr_set_level (old_level);
+}
+
+/* Turns PCIDs on if the CPU supports them. Must run while CR3 holds
+ * PCID 0, before any pml4 other than base_pml4 is activated. */
+void
+pcid_init (void) {
+	uint32_t a, b, c, d, max_leaf;
+
+	cpuid (0, 0, &max_leaf, &b, &c, &d);
+	cpuid (1, 0, &a, &b, &c, &d);
+	if (!(c & (1 << 17)))		// CPUID.01H:ECX.PCID
+		return;
+	if (max_leaf >= 7) {
+		cpuid (7, 0, &a, &b, &c, &d);
+		invpcid_enabled = (b & (1 << 10)) != 0;		// CPUID.07H:EBX.INVPCID
+	}
+	ASSERT ((rcr3 () & PCID_MASK) == 0);
+	lcr4 (rcr4 () | CR4_PCIDE);
+	pcid_enabled = true;
+}
+
+/* Returns the table entry of PML4, or a null pointer if PML4 is not
+ * tracked. Must be called with interrupts off. */
+static struct pcid_entry *
+pcid_lookup (uint64_t *pml4) {
+	size_t idx = (vtop (pml4) >> PGBITS) % PCID_TABLE_SIZE;
+
+	for (size_t i = 0; i < PCID_TABLE_SIZE; i++) {
+		struct pcid_entry *e = &pcid_table[(idx + i) % PCID_TABLE_SIZE];
+		if (e->pml4 == pml4)
+			return e;
+		if (e->pml4 == NULL)
+			break;
+	}
+	return NULL;
+}
+
+/* Adds PML4 to the table without a PCID. It gets one when it is first
+ * activated. If the table is full, PML4 runs on PCID 0. */
+static void
+pcid_track (uint64_t *pml4) {
+	size_t idx = (vtop (pml4) >> PGBITS) % PCID_TABLE_SIZE;
+
+	if (!pcid_enabled)
+		return;
+	enum intr_level old_level = intr_disable ();
+	for (size_t i = 0; i < PCID_TABLE_SIZE; i++) {
+		struct pcid_entry *e = &pcid_table[(idx + i) % PCID_TABLE_SIZE];
+		if (e->pml4 == NULL || e->pml4 == PCID_DEAD) {
+			e->pml4 = pml4;
+			e->gen = 0;
+			break;
+		}
+	}
+	intr_set_level (old_level);
+}
+
+static void
+pcid_untrack (uint64_t *pml4) {
+	if (!pcid_enabled)
+		return;
+	enum intr_level old_level = intr_disable ();
+	struct pcid_entry *e = pcid_lookup (pml4);
+	if (e != NULL)
+		e->pml4 = PCID_DEAD;
+	intr_set_level (old_level);
+}
+
+/* Returns true if PML4 is the one loaded in CR3. */
+static bool
+pml4_is_active (uint64_t *pml4) {
+	return (rcr3 () & ~(uint64_t) PCID_MASK) == vtop (pml4);
+}
+
+/* Drops the TLB entry for VA in PML4 after its PTE has changed.
+ * Without PCIDs only the active pml4 can have entries in the TLB.
+ * With them, an inactive pml4 keeps its entries under its PCID, so
+ * they are dropped with INVPCID or, if the CPU lacks it, by giving
+ * PML4 a fresh PCID on its next activation. */
+static void
+pml4_invalidate (uint64_t *pml4, const void *va) {
+	if (pml4_is_active (pml4)) {
+		invlpg ((uint64_t) va);
+		return;
+	}
+	if (!pcid_enabled)
+		return;
+
+	enum intr_level old_level = intr_disable ();
+	struct pcid_entry *e = pcid_lookup (pml4);
+	if (e != NULL && e->gen == pcid_gen) {
+		if (invpcid_enabled)
+			invpcid (INVPCID_ADDR, e->pcid, (uint64_t) va);
+		else
+			e->gen = 0;
+	}
+	intr_set_level (old_level);
+}
+
+/* Drops every TLB entry of PML4, for callers that changed many PTEs
+ * directly (e.g. cleared their accessed bits) instead of one by one. */
+void
+pml4_flush (uint64_t *pml4) {
+	if (pml4_is_active (pml4)) {
+		lcr3 (rcr3 ());		// NOFLUSH 없이 다시 load하면 현재 PCID의 entry가 비워진다
+		return;
+	}
+	if (!pcid_enabled)
+		return;
+
+	enum intr_level old_level = intr_disable ();
+	struct pcid_entry *e = pcid_lookup (pml4);
+	if (e != NULL && e->gen == pcid_gen) {
+		if (invpcid_enabled)
+			invpcid (INVPCID_PCID, e->pcid, 0);
+		else
+			e->gen = 0;
+	}
+	intr_set_level (old_level);
 }
 
 /* Looks up the physical address that corresponds to user virtual
@@ -216,8 +441,10 @@ void *
 pml4_get_page (uint64_t *pml4, const void *uaddr) {
 	ASSERT (is_user_vaddr (uaddr));
 
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) uaddr, 0);
+	uint64_t *pte = leaf_walk (pml4, uaddr);
 
+	if (pte && (*pte & PTE_P) && (*pte & PTE_PS))
+		return ptov (PTE_ADDR (*pte)) + ((uint64_t) uaddr & (HPGSIZE - 1));
 	if (pte && (*pte & PTE_P))
 		return ptov (PTE_ADDR (*pte)) + pg_ofs (uaddr);
 	return NULL;
@@ -244,11 +471,28 @@ pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw) {
 
 	uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, 1);
 
-	if (pte)
+	if (pte) {
+		bool was_present = (*pte & PTE_P) != 0;
 		*pte = vtop (kpage) | PTE_P | (rw ? PTE_W : 0) | PTE_U;
+		if (was_present)
+			pml4_invalidate (pml4, upage);	// 다른 frame을 가리키던 entry가 TLB에 남지 않도록
+	}
 	return pte != NULL;
 }
 
+/* Points the present PTE for user virtual page UPAGE in PML4 at KPAGE,
+ * keeping its other bits. Used to move a frame to other memory. */
+void
+pml4_move_page (uint64_t *pml4, void *upage, void *kpage) {
+	ASSERT (pg_ofs (kpage) == 0);
+
+	uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, false);
+	if (pte != NULL && (*pte & PTE_P) != 0) {
+		*pte = (*pte & PTE_FLAGS) | vtop (kpage);
+		pml4_invalidate (pml4, upage);
+	}
+}
+
 /* Marks user virtual page UPAGE "not present" in page
  * directory PD.  Later accesses to the page will fault.  Other
  * bits in the page table entry are preserved.
@@ -263,8 +507,7 @@ pml4_clear_page (uint64_t *pml4, void *upage) {
 
 	if (pte != NULL && (*pte & PTE_P) != 0) {
 		*pte &= ~PTE_P;
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) upage);
+		pml4_invalidate (pml4, upage);
 	}
 }
 
@@ -274,7 +517,7 @@ pml4_clear_page (uint64_t *pml4, void *upage) {
  * Returns false if PML4 contains no PTE for VPAGE. */
 bool
 pml4_is_dirty (uint64_t *pml4, const void *vpage) {
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	uint64_t *pte = leaf_walk (pml4, vpage);
 	return pte != NULL && (*pte & PTE_D) != 0;
 }
 
@@ -289,8 +532,7 @@ pml4_set_dirty (uint64_t *pml4, const void *vpage, bool dirty) {
 		else
 			*pte &= ~(uint32_t) PTE_D;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		pml4_invalidate (pml4, vpage);
 	}
 }
 
@@ -300,22 +542,119 @@ pml4_set_dirty (uint64_t *pml4, const void *vpage, bool dirty) {
  * PML4 contains no PTE for VPAGE. */
 bool
 pml4_is_accessed (uint64_t *pml4, const void *vpage) {
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	uint64_t *pte = leaf_walk (pml4, vpage);
 	return pte != NULL && (*pte & PTE_A) != 0;
 }
 
 /* Sets the accessed bit to ACCESSED in the PTE for virtual page
-   VPAGE in PD. */
+   VPAGE in PD. In a 2MB mapping this sets the bit for all of it. */
 void
 pml4_set_accessed (uint64_t *pml4, const void *vpage, bool accessed) {
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	uint64_t *pte = leaf_walk (pml4, vpage);
 	if (pte) {
 		if (accessed)
 			*pte |= PTE_A;
 		else
 			*pte &= ~(uint32_t) PTE_A;
 
-		if (rcr3 () == vtop (pml4))
-			invlpg ((uint64_t) vpage);
+		pml4_invalidate (pml4, vpage);
+	}
+}
+
+/* Replaces the page table that maps the 2MB-aligned user region at
+ * UPAGE in PML4 by a single 2MB mapping. Only done if its 512 entries
+ * are present, map a 2MB-aligned physical run in order and have the
+ * same permissions. Returns true if the region is now a 2MB page. */
+bool
+pml4_collapse (uint64_t *pml4, void *upage) {
+	ASSERT (((uint64_t) upage & (HPGSIZE - 1)) == 0);
+	ASSERT (is_user_vaddr (upage));
+
+	uint64_t *pde = pde_lookup (pml4, upage);
+	if (pde == NULL || (*pde & PTE_P) == 0 || (*pde & PTE_PS) != 0)
+		return false;
+
+	uint64_t *pt = ptov (PTE_ADDR (*pde));
+	uint64_t pa = PTE_ADDR (pt[0]);
+	uint64_t perm = pt[0] & (PTE_P | PTE_W | PTE_U);
+	uint64_t bits = 0;
+
+	if ((perm & PTE_P) == 0 || (pa & (HPGSIZE - 1)) != 0)
+		return false;
+	for (unsigned i = 0; i < PGSIZE / sizeof (uint64_t); i++) {
+		if (PTE_ADDR (pt[i]) != pa + i * PGSIZE
+				|| (pt[i] & (PTE_P | PTE_W | PTE_U)) != perm)
+			return false;
+		bits |= pt[i] & (PTE_A | PTE_D);
 	}
+
+	*pde = pa | perm | bits | PTE_PS;
+	palloc_free_page (pt);
+	for (unsigned i = 0; i < PGSIZE / sizeof (uint64_t); i++)
+		pml4_invalidate (pml4, upage + i * PGSIZE);
+	return true;
+}
+
+/* Replaces the 2MB mapping VA is in, if any, by 4KB mappings of the
+ * same memory. Lets callers that cannot allocate later (e.g. with
+ * interrupts off) split ahead of time. Returns false if out of memory. */
+bool
+pml4_split (uint64_t *pml4, const void *va) {
+	uint64_t *pde = huge_pde (pml4, va);
+	return pde == NULL || split_huge (pde);
+}
+
+/* Returns true if VA is in a 2MB mapping of PML4. */
+bool
+pml4_is_huge (uint64_t *pml4, const void *va) {
+	return huge_pde (pml4, va) != NULL;
+}
+
+/* Returns the PDE for VA in PML4, or NULL if there is no page directory
+ * for it. */
+static uint64_t *
+pde_lookup (uint64_t *pml4, const void *va) {
+	uint64_t e = pml4[PML4 (va)];
+	if ((e & PTE_P) == 0)
+		return NULL;
+	e = ((uint64_t *) ptov (PTE_ADDR (e)))[PDPE (va)];
+	if ((e & PTE_P) == 0)
+		return NULL;
+	return &((uint64_t *) ptov (PTE_ADDR (e)))[PDX (va)];
+}
+
+/* Returns the PDE of the 2MB mapping VA is in, or NULL. */
+static uint64_t *
+huge_pde (uint64_t *pml4, const void *va) {
+	uint64_t *pde = pde_lookup (pml4, va);
+	if (pde != NULL && (*pde & (PTE_P | PTE_PS)) == (PTE_P | PTE_PS))
+		return pde;
+	return NULL;
+}
+
+/* Returns the entry that maps VA: its PDE if VA is in a 2MB mapping,
+ * otherwise its PTE. Unlike pml4e_walk() this never splits a 2MB
+ * mapping, so it is for looking at the bits shared by the whole of it. */
+static uint64_t *
+leaf_walk (uint64_t *pml4, const void *va) {
+	uint64_t *pde = huge_pde (pml4, va);
+	return pde != NULL ? pde : pml4e_walk (pml4, (uint64_t) va, false);
+}
+
+/* Replaces the 2MB mapping in *PDE by a page table whose 512 entries map
+ * the same memory with the same bits. The TLB entry for the 2MB page
+ * stays valid, as it translates the same way. Returns false, leaving the
+ * 2MB mapping, if no page is left for the page table. */
+static bool
+split_huge (uint64_t *pde) {
+	uint64_t *pt = palloc_get_page (0);
+	if (pt == NULL)
+		return false;
+	uint64_t pa = PTE_ADDR (*pde);
+	uint64_t bits = *pde & PTE_FLAGS & ~(uint64_t) PTE_PS;
+
+	for (unsigned i = 0; i < PGSIZE / sizeof (uint64_t); i++)
+		pt[i] = (pa + i * PGSIZE) | bits;
+	*pde = vtop (pt) | PTE_U | PTE_W | PTE_P;
+	return true;
 }
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -24,7 +25,13 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   The split is not fixed, though: a pool that runs out borrows a
+   free chunk of LOAN_PAGES pages from the other one and gives it
+   back once every page of it is freed. The kernel pool never
+   lends below its floor, so it keeps memory for itself however
+   many frames user processes want. */
 /* 페이지 할당자 */
 /* A memory pool. */
 struct pool {
@@ -43,6 +50,39 @@ init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
 
+/* Pool rebalancing. */
+#define LOAN_PAGES 64			/* 한 번에 빌려주는 page 수 (256 kB) */
+#define LOAN_MAX 128			/* 동시에 빌려줄 수 있는 chunk 수 */
+#define LOAN_MAP_BYTES 32		/* LOAN_PAGES bit짜리 bitmap을 담을 크기 */
+
+/* A chunk of one pool lent to the other. Its pages stay allocated in
+ * the lender's bitmap while the borrower hands them out. */
+struct loan {
+	struct pool *lender;		/* NULL이면 빈 slot */
+	struct pool *borrower;
+	uint8_t *base;				/* 첫 page */
+	size_t used;				/* borrower가 쓰고 있는 page 수 */
+	struct bitmap *used_map;	/* borrower가 쓰고 있는 page들 */
+	uint8_t map_buf[LOAN_MAP_BYTES];
+};
+
+/* Loans are looked up on every free, including the one of a dying
+ * thread's page in the scheduler, so they are protected by disabling
+ * interrupts rather than by a lock. */
+static struct loan loans[LOAN_MAX];
+static size_t loan_cnt;			/* 쓰고 있는 slot 수 */
+static size_t kern_floor;		/* kernel pool이 빌려주고도 남겨둘 빈 page 수 */
+
+/* Statistics. */
+static long long kern_borrow_cnt;	/* kernel pool이 빌린 chunk 수 */
+static long long user_borrow_cnt;	/* user pool이 빌린 chunk 수 */
+static long long return_cnt;		/* 돌려준 chunk 수 */
+
+static void *loan_alloc (struct pool *borrower, size_t page_cnt);
+static bool loan_free (void *pages, size_t page_cnt);
+static size_t loan_free_cnt (const struct pool *borrower);
+static size_t loan_pages (const struct pool *pool, bool lent);
+
 /* multiboot info */
 struct multiboot_info {
 	uint32_t flags;
@@ -250,6 +290,11 @@ palloc_init (void) {
 	printf ("\text_mem: 0x%llx ~ 0x%llx (Usable: %'llu kB)\n",
 		  ext_mem.start, ext_mem.end, ext_mem.size / 1024);
 	populate_pools (&base_mem, &ext_mem);
+
+	ASSERT (bitmap_buf_size (LOAN_PAGES) <= LOAN_MAP_BYTES);
+	kern_floor = bitmap_size (kernel_pool.used_map) / 4;
+	if (kern_floor < LOAN_PAGES)
+		kern_floor = LOAN_PAGES;
 	return ext_mem.end;
 }
 
@@ -276,7 +321,7 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	if (page_idx != BITMAP_ERROR)
 		pages = pool->base + PGSIZE * page_idx;
 	else
-		pages = NULL;
+		pages = loan_alloc (pool, page_cnt);	// 다른 pool에서 빌려온다
 
 	if (pages) {
 		if (flags & PAL_ZERO)
@@ -311,6 +356,12 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 	if (pages == NULL || page_cnt == 0)
 		return;
 
+#ifndef NDEBUG
+	memset (pages, 0xcc, PGSIZE * page_cnt);
+#endif
+	if (loan_cnt > 0 && loan_free (pages, page_cnt))
+		return;
+
 	if (page_from_pool (&kernel_pool, pages))
 		pool = &kernel_pool;
 	else if (page_from_pool (&user_pool, pages))
@@ -320,9 +371,6 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 
 	page_idx = pg_no (pages) - pg_no (pool->base);
 
-#ifndef NDEBUG
-	memset (pages, 0xcc, PGSIZE * page_cnt);
-#endif
 	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
 	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
 }
@@ -333,6 +381,242 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* Returns the number of pages user allocations can still get: the free
+ * pages of the user pool and of the chunks it borrowed, plus what the
+ * kernel pool could lend above its floor. */
+size_t
+palloc_user_free_cnt (void) {
+	size_t cnt, kern_free;
+
+	lock_acquire (&user_pool.lock);
+	cnt = bitmap_count (user_pool.used_map, 0, bitmap_size (user_pool.used_map),
+			false);
+	lock_release (&user_pool.lock);
+	kern_free = bitmap_count (kernel_pool.used_map, 0,
+			bitmap_size (kernel_pool.used_map), false);
+	if (kern_free > kern_floor)
+		cnt += (kern_free - kern_floor) / LOAN_PAGES * LOAN_PAGES;
+	return cnt + loan_free_cnt (&user_pool);
+}
+
+/* Returns the number of pages from the start of the lower pool to the
+ * end of the higher one, which palloc_page_idx() numbers. */
+size_t
+palloc_page_cnt (void) {
+	uint8_t *lo = kernel_pool.base < user_pool.base
+			? kernel_pool.base : user_pool.base;
+	uint8_t *kern_end = kernel_pool.base
+			+ bitmap_size (kernel_pool.used_map) * PGSIZE;
+	uint8_t *user_end = user_pool.base
+			+ bitmap_size (user_pool.used_map) * PGSIZE;
+	uint8_t *hi = kern_end > user_end ? kern_end : user_end;
+
+	return pg_no (hi) - pg_no (lo);
+}
+
+/* Returns a number below palloc_page_cnt() for PAGE, or SIZE_MAX if
+ * PAGE is in neither pool. Unlike palloc_user_page_idx() this also
+ * numbers kernel pool pages the user pool has borrowed. */
+size_t
+palloc_page_idx (const void *page) {
+	uint8_t *lo = kernel_pool.base < user_pool.base
+			? kernel_pool.base : user_pool.base;
+
+	if (!page_from_pool (&kernel_pool, (void *) page)
+			&& !page_from_pool (&user_pool, (void *) page))
+		return SIZE_MAX;
+	return pg_no (page) - pg_no (lo);
+}
+
+void
+palloc_print_stats (void) {
+	printf ("Pools: kernel %zu pages (+%zu borrowed, -%zu lent), "
+			"user %zu pages (+%zu borrowed, -%zu lent)\n",
+			bitmap_size (kernel_pool.used_map), loan_pages (&kernel_pool, false),
+			loan_pages (&kernel_pool, true), bitmap_size (user_pool.used_map),
+			loan_pages (&user_pool, false), loan_pages (&user_pool, true));
+	printf ("Pool loans: kernel borrowed %lld, user borrowed %lld, "
+			"%lld returned, kernel floor %zu pages\n",
+			kern_borrow_cnt, user_borrow_cnt, return_cnt, kern_floor);
+}
+
+/* Allocates PAGE_CNT pages for BORROWER from a chunk it borrowed,
+ * borrowing a new chunk from the other pool if none has room. Returns
+ * a null pointer if that fails too. */
+static void *
+loan_alloc (struct pool *borrower, size_t page_cnt) {
+	struct pool *lender = borrower == &kernel_pool ? &user_pool : &kernel_pool;
+	struct loan *loan = NULL, *free_slot = NULL;
+	size_t idx = BITMAP_ERROR;
+
+	if (page_cnt > LOAN_PAGES)
+		return NULL;
+
+	lock_acquire (&lender->lock);
+	enum intr_level old_level = intr_disable ();
+	for (int i = 0; i < LOAN_MAX && idx == BITMAP_ERROR; i++) {
+		if (loans[i].lender == NULL) {
+			if (free_slot == NULL)
+				free_slot = &loans[i];
+		} else if (loans[i].borrower == borrower) {
+			loan = &loans[i];
+			idx = bitmap_scan_and_flip (loan->used_map, 0, page_cnt, false);
+		}
+	}
+	if (idx == BITMAP_ERROR && free_slot != NULL) {
+		// 새 chunk를 빌린다 (kernel pool은 floor 아래로는 안 빌려줌)
+		size_t lender_idx = BITMAP_ERROR;
+		size_t lender_free = bitmap_count (lender->used_map, 0,
+				bitmap_size (lender->used_map), false);
+		if (lender != &kernel_pool || lender_free >= kern_floor + LOAN_PAGES)
+			lender_idx = bitmap_scan_and_flip (lender->used_map, 0, LOAN_PAGES,
+					false);
+		if (lender_idx != BITMAP_ERROR) {
+			loan = free_slot;
+			loan->lender = lender;
+			loan->borrower = borrower;
+			loan->base = lender->base + PGSIZE * lender_idx;
+			loan->used = 0;
+			loan->used_map = bitmap_create_in_buf (LOAN_PAGES, loan->map_buf,
+					sizeof loan->map_buf);
+			loan_cnt++;
+			if (borrower == &kernel_pool)
+				kern_borrow_cnt++;
+			else
+				user_borrow_cnt++;
+			idx = bitmap_scan_and_flip (loan->used_map, 0, page_cnt, false);
+		}
+	}
+	if (idx != BITMAP_ERROR)
+		loan->used += page_cnt;
+	intr_set_level (old_level);
+	lock_release (&lender->lock);
+
+	return idx != BITMAP_ERROR ? loan->base + PGSIZE * idx : NULL;
+}
+
+/* Frees PAGE_CNT pages at PAGES if they belong to a borrowed chunk, and
+ * gives the chunk back once none of it is used. Returns false if PAGES
+ * is not in a borrowed chunk. */
+static bool
+loan_free (void *pages, size_t page_cnt) {
+	uint8_t *p = pages;
+	bool found = false;
+
+	enum intr_level old_level = intr_disable ();
+	for (int i = 0; i < LOAN_MAX; i++) {
+		struct loan *loan = &loans[i];
+		if (loan->lender == NULL || p < loan->base
+				|| p >= loan->base + LOAN_PAGES * PGSIZE)
+			continue;
+
+		size_t idx = (p - loan->base) / PGSIZE;
+		ASSERT (bitmap_all (loan->used_map, idx, page_cnt));
+		bitmap_set_multiple (loan->used_map, idx, page_cnt, false);
+		loan->used -= page_cnt;
+		if (loan->used == 0) {
+			struct pool *lender = loan->lender;
+			bitmap_set_multiple (lender->used_map,
+					pg_no (loan->base) - pg_no (lender->base), LOAN_PAGES, false);
+			loan->lender = NULL;
+			loan_cnt--;
+			return_cnt++;
+		}
+		found = true;
+		break;
+	}
+	intr_set_level (old_level);
+	return found;
+}
+
+/* Returns the number of free pages in the chunks BORROWER borrowed. */
+static size_t
+loan_free_cnt (const struct pool *borrower) {
+	size_t cnt = 0;
+
+	enum intr_level old_level = intr_disable ();
+	for (int i = 0; i < LOAN_MAX; i++)
+		if (loans[i].lender != NULL && loans[i].borrower == borrower)
+			cnt += LOAN_PAGES - loans[i].used;
+	intr_set_level (old_level);
+	return cnt;
+}
+
+/* Returns the number of pages POOL has lent out if LENT, otherwise the
+ * number it has borrowed. */
+static size_t
+loan_pages (const struct pool *pool, bool lent) {
+	size_t cnt = 0;
+
+	enum intr_level old_level = intr_disable ();
+	for (int i = 0; i < LOAN_MAX; i++)
+		if (loans[i].lender != NULL
+				&& (lent ? loans[i].lender : loans[i].borrower) == pool)
+			cnt += LOAN_PAGES;
+	intr_set_level (old_level);
+	return cnt;
+}
+
+/* Returns the number of pages in the user pool. */
+size_t
+palloc_user_page_cnt (void) {
+	return bitmap_size (user_pool.used_map);
+}
+
+/* Returns the index of PAGE within the user pool, or SIZE_MAX if PAGE
+ * is not a user pool page. */
+size_t
+palloc_user_page_idx (const void *page) {
+	if (!page_from_pool (&user_pool, (void *) page))
+		return SIZE_MAX;
+	return pg_no (page) - pg_no (user_pool.base);
+}
+
+/* Returns the kernel virtual address of page IDX of the user pool. */
+void *
+palloc_user_page (size_t idx) {
+	ASSERT (idx < bitmap_size (user_pool.used_map));
+	return user_pool.base + PGSIZE * idx;
+}
+
+/* Returns true if page IDX of the user pool is allocated. */
+bool
+palloc_user_page_used (size_t idx) {
+	return bitmap_test (user_pool.used_map, idx);
+}
+
+/* Allocates pages [IDX, IDX + CNT) of the user pool if they are all
+ * free and returns the first one, or a null pointer otherwise. */
+void *
+palloc_user_get_range (size_t idx, size_t cnt) {
+	bool ok;
+
+	lock_acquire (&user_pool.lock);
+	ok = !bitmap_contains (user_pool.used_map, idx, cnt, true);
+	if (ok)
+		bitmap_set_multiple (user_pool.used_map, idx, cnt, true);
+	lock_release (&user_pool.lock);
+	return ok ? palloc_user_page (idx) : NULL;
+}
+
+/* Allocates one user pool page that is not in [IDX, IDX + CNT). Returns
+ * a null pointer if there is none. */
+void *
+palloc_user_get_outside (size_t idx, size_t cnt) {
+	size_t page_idx;
+
+	lock_acquire (&user_pool.lock);
+	page_idx = bitmap_scan_and_flip (user_pool.used_map, 0, 1, false);
+	if (page_idx != BITMAP_ERROR && page_idx >= idx && page_idx < idx + cnt) {
+		// 구간 안에서 찾았으면 돌려놓고 구간 뒤에서 다시 찾는다
+		bitmap_reset (user_pool.used_map, page_idx);
+		page_idx = bitmap_scan_and_flip (user_pool.used_map, idx + cnt, 1,
+				false);
+	}
+	lock_release (&user_pool.lock);
+	return page_idx != BITMAP_ERROR ? palloc_user_page (page_idx) : NULL;
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
@@ -606,6 +606,9 @@ init_thread (struct thread *t, const char *name, int priority) {
 	sema_init(&t->free_sema, 0); /* exit 세마포어 0으로 초기화 */ 
 
 	t->run_file = NULL;
+#ifdef VM
+	t->rss_limit = rss_limit_default;
+#endif
 }
 
 /* Chooses and returns the next thread to be scheduled.  Should
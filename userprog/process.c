@@ -21,6 +21,7 @@
 #include "include/vm/file.h"
 #ifdef VM
 #include "vm/vm.h"
+#include "vm/ksm.h"
 // --------------------project3 Anonymous Page start---------
 #include "vm/file.h"
 // --------------------project3 Anonymous Page end---------
@@ -225,6 +226,8 @@ __do_fork(void *aux)
 
 	process_activate(current);
 #ifdef VM
+	current->rss_limit = parent->rss_limit;	// frame quota는 물려받는다
+	current->ksm_merge = parent->ksm_merge;	// page 병합 참여 여부도
 	supplemental_page_table_init(&current->spt);
 	if (!supplemental_page_table_copy(&current->spt, &parent->spt))
 		goto error;
@@ -420,6 +423,8 @@ process_cleanup(void)
 	struct thread *curr = thread_current();
 
 #ifdef VM
+	ksm_leave(curr);	// ksmd가 없어질 spt를 보지 않도록
+	vm_space_leave(curr);	// eviction 정책이 없어질 pml4를 훑지 않도록
 	// supplemental_page_table_kill(&curr->spt);
 	if(!hash_empty(&curr->spt.spt_hash)) {
 		supplemental_page_table_kill(&curr->spt);
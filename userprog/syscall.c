@@ -13,6 +13,8 @@
 #include "userprog/process.h"
 #include "vm/vm.h"
 #include "vm/file.h"
+#include "vm/madvise.h"
+#include "vm/ksm.h"
 #include "filesys/file.h"
 #include "filesys/inode.h"
 
@@ -39,6 +41,9 @@ void seek(int fd, unsigned position);
 unsigned tell(int fd);
 void *mmap(void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap(void *addr);
+int madvise(void *addr, size_t length, int advice);
+size_t rsslimit(size_t frames);
+bool memmerge(bool enable);
 void check_valid_buffer(void *buffer, unsigned size, void *rsp, bool to_write);
 
 // ------------project4 - Subdirectories and Soft Links start------------
@@ -48,6 +53,7 @@ bool mkdir(const char *dir);
 bool readdir(int fd, char *name);
 int inumber(int fd);
 int symlink(const char *target, const char *linkpath);
+int fallocate(int fd, off_t offset, off_t len);
 // ------------project4 - Subdirectories and Soft Links end------------
 struct lock filesys_lock;
 
@@ -167,6 +173,15 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	case SYS_MUNMAP:
 		munmap(f->R.rdi);
 		break;
+	case SYS_MADVISE:
+		f->R.rax = madvise((void *)f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
+	case SYS_RSSLIMIT:
+		f->R.rax = rsslimit(f->R.rdi);
+		break;
+	case SYS_MEMMERGE:
+		f->R.rax = memmerge(f->R.rdi);
+		break;
 	// --------------------project3 Memory Mapped Files end-----------
 
 	//------project4-subdirectory start-----------------------
@@ -188,6 +203,9 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	case SYS_SYMLINK:
 		f->R.rax = symlink(f->R.rdi, f->R.rsi);
 		break;
+	case SYS_FALLOCATE:
+		f->R.rax = fallocate(f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
 	//------project4-subdirectory end--------------------------
 	default:
 		exit(-1);
@@ -322,7 +340,14 @@ int write(int fd, const void *buffer, unsigned size)
 	else
 	{
 		lock_acquire(&filesys_lock);
+#ifdef VM
+		// page cache를 거쳐서 써야 같은 파일을 mmap한 프로세스가 바로 본다
+		off_t pos = file_tell(file);
+		int bytes_written = page_cache_write(file_get_inode(file), buffer, size, pos);
+		file_seek(file, pos + bytes_written);
+#else
 		int bytes_written = file_write(file, buffer, size);
+#endif
 		lock_release(&filesys_lock);
 		return bytes_written;
 	}
@@ -421,7 +446,14 @@ int read(int fd, void *buffer, unsigned size)
 	{
 		// 정상일 때 file_read
 		lock_acquire(&filesys_lock);
+#ifdef VM
+		// mmap으로 수정되고 아직 write back되지 않은 내용도 page cache에서 읽힌다
+		off_t pos = file_tell(file);
+		read_size = page_cache_read(file_get_inode(file), buffer, size, pos);
+		file_seek(file, pos + read_size);
+#else
 		read_size = file_read(file, buffer, size); // 실제 읽은 사이즈 return
+#endif
 		lock_release(&filesys_lock);
 	}
 	return read_size;
@@ -495,12 +527,41 @@ void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 		return NULL;
 	}
 
-	return do_mmap(addr, length, writable, target, offset);
+	bool locked = vm_lock_acquire();
+	void *ret = do_mmap(addr, length, writable, target, offset);
+	vm_lock_release(locked);
+	return ret;
 }
 
 void munmap(void *addr)
 {
+	bool locked = vm_lock_acquire();
 	do_munmap(addr);
+	vm_lock_release(locked);
+}
+
+/* addr부터 length만큼의 영역에 대한 사용 패턴을 커널에 알려줌 (vm/madvise.c) */
+int madvise(void *addr, size_t length, int advice)
+{
+	return do_madvise(addr, length, advice);
+}
+
+/* 이 프로세스의 frame quota를 frames로 바꾸고 이전 값을 반환함 (0이면 제한 없음) */
+size_t rsslimit(size_t frames)
+{
+	bool locked = vm_lock_acquire();
+	size_t old = vm_set_rss_limit(frames);
+	vm_lock_release(locked);
+	return old;
+}
+
+/* ksmd가 이 프로세스의 같은 내용 page들을 합쳐도 되는지 정하고 이전 값을 반환함 (vm/ksm.c) */
+bool memmerge(bool enable)
+{
+	bool locked = vm_lock_acquire();
+	bool old = ksm_set(enable);
+	vm_lock_release(locked);
+	return old;
 }
 
 void check_valid_buffer(void *buffer, unsigned size, void *rsp, bool to_write)
@@ -515,11 +576,19 @@ void check_valid_buffer(void *buffer, unsigned size, void *rsp, bool to_write)
 	{
 		// 인자로 받은 buffer부터 buffer + size까지의 크기가 한 페이지의 크기를 넘을수도 있음
 		struct page *page = check_address(buffer + i);
-		if (page == NULL)
-			exit(-1);
+		bool writable;
+		if (page != NULL)
+			writable = page->writable;
+		else {
+			// mmap한 구간은 아직 fault가 안 났으면 page가 없다
+			struct vm_area *vma = vma_find(&thread_current()->spt.vmas, buffer + i);
+			if (vma == NULL)
+				exit(-1);
+			writable = (vma->prot & VMA_WRITE) != 0;
+		}
 		// to_write인자는 SYS_READ이면 true로, SYS_WRITE이면 false로 들어옴
 		// SYS_READ일 때는 file(DISK)에서 buffer(MEM)로 write를 해야하기 때문에, page의 writable이 항상 true여야 함
-		if (to_write == true && page->writable == false)
+		if (to_write == true && writable == false)
 			exit(-1);
 	}
 }
@@ -563,4 +632,27 @@ int symlink(const char *target, const char *linkpath)
 {
 
 }
+
+// fd의 offset부터 len byte만큼 disk 공간을 미리 잡아둠, 파일이 더 짧으면 0으로 늘어남
+// 성공하면 0, 실패하면 -1 반환
+int fallocate(int fd, off_t offset, off_t len)
+{
+	struct file *file = fd_to_file(fd);
+	if (file == NULL || fd < 2)
+	{
+		return -1;
+	}
+
+	lock_acquire(&filesys_lock);
+#ifdef VM
+	// page fault가 같은 파일을 읽는 동안 길이가 바뀌면 안 됨
+	bool locked = vm_lock_acquire();
+#endif
+	bool success = file_allocate(file, offset, len);
+#ifdef VM
+	vm_lock_release(locked);
+#endif
+	lock_release(&filesys_lock);
+	return success ? 0 : -1;
+}
 //------project4-end--------------------------
\ No newline at end of file
@@ -4,16 +4,22 @@
 #include "devices/disk.h"
 #include "lib/kernel/bitmap.h"
 #include "threads/mmu.h"
+#include <stdio.h>
+#include "vm/zswap.h"
+#include "vm/ksm.h"
 
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
 //-------project3-swap in out start----------------
 struct bitmap* swap_table;
 size_t swap_size;
+static long long same_filled_out_cnt;	// 같은 값으로 채워져 disk를 건너뛴 swap out 수
+static long long same_filled_in_cnt;	// fill로 복원한 swap in 수
 //-------project3-swap in out end----------------
 static bool anon_swap_in (struct page *page, void *kva);
 static bool anon_swap_out (struct page *page);
 static void anon_destroy (struct page *page);
+static bool page_same_filled (const void *kva, uint64_t *fill);
 
 /* DO NOT MODIFY this struct */
 static const struct page_operations anon_ops = {
@@ -34,6 +40,7 @@ vm_anon_init (void) { // 익명 페이지 하위 시스템을 초기화
 	swap_size = disk_size(swap_disk)/8; // SECTORS_PER_PAGE;	// 1page = 1slot = 8sector
 	swap_table = bitmap_create(swap_size);  // swap_table을 bitmap자료구조로 만듬.
 	//-------project3-swap in out end----------------
+	zswap_init();	// swap disk 앞단의 압축 RAM 계층
 }
 
 /* Initialize the file mapping */
@@ -49,6 +56,12 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {
 	//-------project3-swap in out end----------------
 	page->operations = &anon_ops;
 	struct anon_page *anon_page = &page->anon;
+	anon_page->swap_location = -1;	// 아직 swap disk에 자리가 없음
+	anon_page->zswap = NULL;
+	anon_page->same_filled = false;
+	anon_page->ksm = NULL;
+	anon_page->ksm_unstable = false;
+	anon_page->ksm_seen = false;
 
 	return true;
 }
@@ -58,19 +71,34 @@ static bool
 anon_swap_in (struct page *page, void *kva) {
 	struct anon_page *anon_page = &page->anon;
 	//-------project3-swap in out start----------------
+	// 한 word로만 채워져 있던 페이지는 저장해둔 값으로 다시 채운다
+	if (anon_page->same_filled) {
+		uint64_t *p = kva;
+		for (size_t i = 0; i < PGSIZE / sizeof *p; i++)
+			p[i] = anon_page->fill;
+		anon_page->same_filled = false;
+		same_filled_in_cnt++;
+		return true;
+	}
+
+	// 압축되어 RAM에 남아있다면 disk I/O 없이 바로 복원.
+	// zswap에 있는지는 zswap_lock 아래에서 판단해야 한다. 그 사이 disk로 write back
+	// 됐다면 zswap_load()가 false를 돌려주고, swap_location의 slot에서 읽으면 된다.
+	if (zswap_load(page, kva)) {
+		return true;
+	}
+
 	int bitmap_idx = anon_page->swap_location;
 
-	if(bitmap_test(swap_table, bitmap_idx) == false) {
+	if(bitmap_idx < 0 || bitmap_test(swap_table, bitmap_idx) == false) {
 		return false;	// bitmap에 false로 표시되었다면, 읽을 수 없으므로 종료
 	}
 	// swap area(disk)에서 frame으로(kva통해서) read하기 
-	for (int i=0; i<SECTORS_PER_PAGE; i++) {
-		disk_read(swap_disk, bitmap_idx*SECTORS_PER_PAGE + i, kva + DISK_SECTOR_SIZE*i);
-	}
+	swap_slot_read(bitmap_idx, kva);
 
 	// swap table 업데이트
-	bitmap_set(swap_table, bitmap_idx, false);	// bitmap을 다시 false로 세팅
-	// bitmap_flip(swap_table, bitmap_idx);
+	swap_slot_free(bitmap_idx);	// bitmap을 다시 false로 세팅
+	anon_page->swap_location = -1;
 
 	return true;
 	//-------project3-swap in out end----------------
@@ -81,31 +109,125 @@ static bool
 anon_swap_out (struct page *page) {
 	struct anon_page *anon_page = &page->anon;
 	//-------project3-swap in out start----------------
-	// bitmap값이 0인 page를 찾는다.
-	int bitmap_idx = bitmap_scan(swap_table, 0, 1, false);	// bitmap_idx = slot_no
-	if (bitmap_idx == BITMAP_ERROR) {	
-		return false;	// 찾지 못한 경우 
+	// page->va는 현재 프로세스의 주소공간에서만 유효하므로 frame의 kva에서 읽는다.
+	void *kva = page->frame->kva;
+	ksm_forget(page);	// frame이 없는 page는 합칠 후보가 아니다
+
+	// 0 같은 한 word로만 채워진 페이지는 tag만 남기고 어디에도 저장하지 않는다.
+	// 그 외에는 압축해서 RAM(zswap)에 보관해보고, 압축이 안 되거나 자리가 없으면 disk로
+	if (page_same_filled(kva, &anon_page->fill)) {
+		anon_page->same_filled = true;
+		same_filled_out_cnt++;
+	} else if (!zswap_store(page, kva)) {
+		size_t bitmap_idx = swap_slot_write(kva);	// bitmap_idx = slot_no
+		if (bitmap_idx == BITMAP_ERROR) {	
+			return false;	// 빈 slot을 찾지 못한 경우 
+		}
+		// anon_page구조체에 page위치 저장
+		anon_page->swap_location = bitmap_idx;
 	}
 	
+	pml4_clear_page(page->owner->pml4, page->va);	// pml4에서 삭제 (다른 프로세스의 page일 수도 있음)
+	return true;
+	//-------project3-swap in out end----------------
+}
+
+//-------project3-swap in out start----------------
+/* Writes the page at KVA into a free swap slot and returns the slot
+ * number, or BITMAP_ERROR if the swap disk is full. */
+size_t
+swap_slot_write (const void *kva) {
+	// bitmap값이 0인 slot을 찾아서 바로 사용중으로 표시
+	size_t bitmap_idx = bitmap_scan_and_flip(swap_table, 0, 1, false);
+	if (bitmap_idx == BITMAP_ERROR) {
+		return BITMAP_ERROR;
+	}
+
 	// disk에 변경사항 write해줌, 1page = 8sector = 8slot
 	for (int i=0; i < SECTORS_PER_PAGE; i++) {
 		// DISK_SECTOR_SIZE = 512 = 1섹터의 크기가 512bytes이기 때문
-		disk_write(swap_disk, bitmap_idx*SECTORS_PER_PAGE + i, page->va + DISK_SECTOR_SIZE*i);
+		disk_write(swap_disk, bitmap_idx*SECTORS_PER_PAGE + i, kva + DISK_SECTOR_SIZE*i);
 	}
+	return bitmap_idx;
+}
 
-	bitmap_set(swap_table, bitmap_idx, true);	// bitmap을 다시 true로 세팅
-	// bitmap_flip(swap_table, bitmap_idx);
-	
-	pml4_clear_page(thread_current()->pml4, page->va);	// pml4에서 삭제
+/* Reads swap slot SLOT into the page at KVA. */
+void
+swap_slot_read (size_t slot, void *kva) {
+	for (int i=0; i<SECTORS_PER_PAGE; i++) {
+		disk_read(swap_disk, slot*SECTORS_PER_PAGE + i, kva + DISK_SECTOR_SIZE*i);
+	}
+}
 
-	// anon_page구조체에 page위치 저장
-	anon_page->swap_location = bitmap_idx;
+/* Returns true if the page at KVA consists of a single repeated 8-byte
+ * word, storing that word in *FILL. */
+static bool
+page_same_filled (const void *kva, uint64_t *fill) {
+	const uint64_t *p = kva;
+	for (size_t i = 1; i < PGSIZE / sizeof *p; i++) {
+		if (p[i] != p[0])
+			return false;
+	}
+	*fill = p[0];
 	return true;
-	//-------project3-swap in out end----------------
+}
+
+void
+anon_print_stats (void) {
+	printf ("Anon: %lld same-filled pages swapped out, %lld filled back in\n",
+			same_filled_out_cnt, same_filled_in_cnt);
+}
+
+/* Marks swap slot SLOT free. */
+void
+swap_slot_free (size_t slot) {
+	bitmap_set(swap_table, slot, false);
+}
+//-------project3-swap in out end----------------
+
+/* Returns true if PAGE has been initialized as an anonymous page. */
+bool
+page_is_anon (struct page *page) {
+	return page->operations == &anon_ops;
+}
+
+/* Returns true if PAGE is an anonymous page without a frame that is
+ * known to hold only zeros. */
+bool
+anon_is_zero (struct page *page) {
+	return page->operations == &anon_ops && page->frame == NULL
+		&& page->anon.same_filled && page->anon.fill == 0;
+}
+
+/* Forgets the contents of PAGE for MADV_DONTNEED so that its next fault
+ * reads back zeros. Its frame, if any, must already be released. Returns
+ * false if PAGE is not an anonymous page or held nothing in swap. */
+bool
+anon_discard (struct page *page) {
+	struct anon_page *anon_page = &page->anon;
+
+	if (page->operations != &anon_ops)
+		return false;
+	bool held = anon_page->zswap != NULL || anon_page->swap_location >= 0
+		|| anon_page->same_filled;
+	anon_destroy (page);
+	anon_page->same_filled = true;	// 0으로 채워진 채 쫓겨난 page와 똑같이 취급
+	anon_page->fill = 0;
+	return held;
 }
 
 /* Destroy the anonymous page. PAGE will be freed by the caller. */
 static void
 anon_destroy (struct page *page) {
 	struct anon_page *anon_page = &page->anon;
+	//-------project3-swap in out start----------------
+	// 쫓겨난 상태로 죽는 페이지는 RAM/disk에 잡고 있던 자리를 돌려준다.
+	ksm_forget(page);
+	zswap_invalidate(page);
+	anon_page->same_filled = false;
+	if (anon_page->swap_location >= 0) {
+		swap_slot_free(anon_page->swap_location);
+		anon_page->swap_location = -1;
+	}
+	//-------project3-swap in out end----------------
 }
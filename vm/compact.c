@@ -0,0 +1,240 @@
+/* compact.c: Physical memory compaction.
+ *
+ * 오래 돌면 user pool의 빈 page가 여기저기 흩어져서 빈 page가 많아도
+ * 연속된 page 여러 장은 얻을 수 없다. compact_alloc()은 그런 구간 중에서
+ * 옮길 수 있는 frame만 들어 있고 그 수가 가장 적은 곳을 골라 frame들을
+ * 구간 밖의 빈 page로 옮기고(migration), 모든 주소 공간의 pte를 새 page로
+ * 고친 뒤 비워진 구간을 통째로 할당한다. struct frame은 그대로 두고 kva만
+ * 바꾸므로 page->frame 등 frame을 가리키는 포인터는 고칠 필요가 없다. */
+
+#include "vm/compact.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/vaddr.h"
+#include "vm/kswapd.h"
+#include "vm/vm.h"
+
+/* Where one page of the window goes. */
+struct move {
+	struct frame *frame;	/* 옮길 frame, 빈 page면 NULL */
+	void *kva;				/* 옮겨갈 page */
+};
+
+/* State of one page-table walk that fixes up the window's mappings. */
+struct remap {
+	uint64_t *pml4;
+	uint64_t base;			/* 구간 첫 page의 물리 주소 */
+	size_t cnt;
+	struct move *moves;
+	bool ok;				/* split_pte()가 2MB page를 모두 쪼갰음 */
+};
+
+/* Statistics. */
+static long long success_cnt;	/* frame을 옮겨서 구간을 만든 횟수 */
+static long long fail_cnt;		/* 구간을 못 만든 횟수 */
+static long long migrate_cnt;	/* 옮긴 frame 수 */
+
+static bool movable (size_t idx);
+static size_t find_window (size_t cnt, size_t align, size_t *used);
+static void *migrate (size_t start, size_t cnt);
+static bool split_space (struct thread *t, void *aux);
+static bool split_pte (uint64_t *pte, void *va, void *aux);
+static bool remap_space (struct thread *t, void *aux);
+static bool remap_pte (uint64_t *pte, void *va, void *aux);
+
+/* Returns PAGE_CNT contiguous user pool pages whose physical address is
+ * a multiple of ALIGN pages, moving frames out of the way if no such
+ * run is free. Returns a null pointer if no run can be assembled. */
+void *
+compact_alloc (size_t page_cnt, size_t align) {
+	bool locked = vm_lock_acquire ();
+	size_t used, start;
+	void *pages = NULL;
+
+	ASSERT (page_cnt > 0 && align > 0);
+
+	// 옮겨갈 자리가 모자라면 evict해서 만든다
+	while (palloc_user_free_cnt () < page_cnt) {
+		size_t written;
+		if (vm_reclaim (KSWAPD_BATCH, &written) == 0)
+			break;
+	}
+
+	start = find_window (page_cnt, align, &used);
+	if (start != SIZE_MAX && used == 0)
+		pages = palloc_user_get_range (start, page_cnt);
+	else if (start != SIZE_MAX) {
+		pages = migrate (start, page_cnt);
+		if (pages != NULL)
+			success_cnt++;
+	}
+	if (pages == NULL)
+		fail_cnt++;
+
+	vm_lock_release (locked);
+	return pages;
+}
+
+void
+compact_print_stats (void) {
+	printf ("Compaction: %lld succeeded, %lld failed, %lld frames migrated\n",
+			success_cnt, fail_cnt, migrate_cnt);
+}
+
+/* Returns true if user pool page IDX holds a frame that can be moved.
+ * Pages allocated outside the frame table and frames still being
+ * filled cannot. */
+static bool
+movable (size_t idx) {
+	struct frame *frame = vm_frame_lookup (palloc_user_page (idx));
+	return frame != NULL && frame->page != NULL;
+}
+
+/* Finds the aligned window of CNT user pool pages that needs the fewest
+ * frames moved, storing that number in *USED. Returns the index of its
+ * first page, or SIZE_MAX if every window holds an unmovable page. */
+static size_t
+find_window (size_t cnt, size_t align, size_t *used) {
+	size_t total = palloc_user_page_cnt ();
+	size_t base_pg = pg_no (vtop (palloc_user_page (0)));
+	size_t best = SIZE_MAX;
+
+	*used = SIZE_MAX;
+	for (size_t start = (align - base_pg % align) % align;
+			start + cnt <= total; start += align) {
+		size_t n = 0, i;
+		for (i = 0; i < cnt; i++) {
+			if (!palloc_user_page_used (start + i))
+				continue;
+			if (!movable (start + i))
+				break;
+			n++;
+		}
+		if (i == cnt && n < *used) {
+			best = start;
+			*used = n;
+			if (n == 0)
+				break;
+		}
+	}
+	return best;
+}
+
+/* Moves every frame in [START, START + CNT) of the user pool elsewhere
+ * and allocates the emptied window. */
+static void *
+migrate (size_t start, size_t cnt) {
+	struct move *moves = calloc (cnt, sizeof *moves);
+	size_t i;
+
+	if (moves == NULL)
+		return NULL;
+	for (i = 0; i < cnt; i++) {
+		if (!palloc_user_page_used (start + i))
+			continue;
+		moves[i].frame = vm_frame_lookup (palloc_user_page (start + i));
+		moves[i].kva = palloc_user_get_outside (start, cnt);
+		if (moves[i].kva == NULL)
+			break;
+	}
+
+	// 구간에 걸친 2MB page는 미리 쪼갠다. interrupt를 끈 동안에는
+	// page table을 할당할 수 없다 (palloc이 lock을 잡는다).
+	struct remap remap = {
+		.base = vtop (palloc_user_page (start)),
+		.cnt = cnt,
+		.moves = moves,
+		.ok = true,
+	};
+	if (i == cnt)
+		vm_for_each_space (split_space, &remap);
+	if (i < cnt || !remap.ok) {
+		// 옮겨갈 page나 page table이 모자람: 받아둔 page를 돌려준다
+		for (size_t j = 0; j < cnt && j <= i; j++)
+			if (moves[j].kva != NULL)
+				palloc_free_page (moves[j].kva);
+		free (moves);
+		return NULL;
+	}
+
+	// 복사하고 pte를 고치는 동안 user 프로그램이 옛 page에 쓰면 안 된다
+	enum intr_level old_level = intr_disable ();
+	for (i = 0; i < cnt; i++)
+		if (moves[i].frame != NULL)
+			memcpy (moves[i].kva, moves[i].frame->kva, PGSIZE);
+	vm_for_each_space (remap_space, &remap);
+	for (i = 0; i < cnt; i++)
+		if (moves[i].frame != NULL) {
+			void *old = moves[i].frame->kva;
+			vm_frame_move (moves[i].frame, moves[i].kva);
+			moves[i].kva = old;		// interrupt를 켠 뒤에 돌려준다
+			migrate_cnt++;
+		}
+	intr_set_level (old_level);
+
+	for (i = 0; i < cnt; i++)
+		if (moves[i].frame != NULL)
+			palloc_free_page (moves[i].kva);
+	free (moves);
+	return palloc_user_get_range (start, cnt);
+}
+
+static bool
+split_space (struct thread *t, void *aux) {
+	struct remap *remap = aux;
+
+	if (t->pml4 != NULL) {
+		remap->pml4 = t->pml4;
+		pml4_for_each_user (t->pml4, split_pte, remap);
+	}
+	return remap->ok;
+}
+
+/* Splits a 2MB page that maps part of the window, so that remap_pte()
+ * only has to change 4KB entries. */
+static bool
+split_pte (uint64_t *pte, void *va, void *aux) {
+	struct remap *remap = aux;
+	uint64_t pa = PTE_ADDR (*pte);
+
+	if ((*pte & PTE_PS) == 0 || pa + HPGSIZE <= remap->base
+			|| pa >= remap->base + remap->cnt * PGSIZE)
+		return true;
+	remap->ok = pml4_split (remap->pml4, va);
+	return remap->ok;
+}
+
+static bool
+remap_space (struct thread *t, void *aux) {
+	struct remap *remap = aux;
+
+	if (t->pml4 != NULL) {
+		remap->pml4 = t->pml4;
+		pml4_for_each_user (t->pml4, remap_pte, remap);
+	}
+	return true;
+}
+
+/* For a 2MB page each 4KB page in it is checked. split_space() has
+ * already split those that have a page to move. */
+static bool
+remap_pte (uint64_t *pte, void *va, void *aux) {
+	struct remap *remap = aux;
+	uint64_t pa = PTE_ADDR (*pte);
+	size_t cnt = *pte & PTE_PS ? HPGSIZE / PGSIZE : 1;
+
+	for (size_t i = 0; i < cnt; i++, pa += PGSIZE) {
+		if (pa < remap->base || pa >= remap->base + remap->cnt * PGSIZE)
+			continue;
+		struct move *m = &remap->moves[(pa - remap->base) / PGSIZE];
+		if (m->frame != NULL)
+			pml4_move_page (remap->pml4, va + i * PGSIZE, m->kva);
+	}
+	return true;
+}
@@ -0,0 +1,96 @@
+/* evict.c: Eviction policy selection and the clock policy.
+ *
+ * 어떤 frame을 evict할지는 struct evict_policy 뒤에 숨겨서 커널 옵션
+ * -evict=NAME으로 고른다. 기본은 frame마다 accessed bit를 보고 두 번째
+ * 기회를 주는 clock이다. */
+
+#include "vm/evict.h"
+#include <list.h>
+#include <stdio.h>
+#include <string.h>
+#include "vm/vm.h"
+
+static void clock_init (void);
+static void clock_add (struct frame *frame);
+static void clock_remove (struct frame *frame);
+static struct frame *clock_victim (void);
+static void clock_print_stats (void);
+
+const struct evict_policy clock_policy = {
+	.name = "clock",
+	.init = clock_init,
+	.add = clock_add,
+	.remove = clock_remove,
+	.victim = clock_victim,
+	.print_stats = clock_print_stats,
+};
+
+static const struct evict_policy *policies[] = {
+	&clock_policy,
+	&mglru_policy,
+};
+
+const struct evict_policy *evict_policy = &clock_policy;
+
+/* Makes the policy called NAME the one used. Returns false if there is
+ * no such policy. */
+bool
+evict_select (const char *name) {
+	for (size_t i = 0; i < sizeof policies / sizeof *policies; i++)
+		if (!strcmp (policies[i]->name, name)) {
+			evict_policy = policies[i];
+			return true;
+		}
+	return false;
+}
+
+static struct list clock_list;		/* 모든 frame, hand 바로 앞이 가장 최근 것 */
+static struct list_elem *hand;		/* 다음에 볼 frame */
+static long long clock_scan_cnt;	/* accessed bit를 본 frame 수 */
+
+static void
+clock_init (void) {
+	list_init (&clock_list);
+	hand = list_end (&clock_list);
+}
+
+/* New frames go right behind the hand, so they are looked at last. */
+static void
+clock_add (struct frame *frame) {
+	list_insert (hand, &frame->lru_elem);
+}
+
+static void
+clock_remove (struct frame *frame) {
+	struct list_elem *next = list_remove (&frame->lru_elem);
+	if (hand == &frame->lru_elem)
+		hand = next;	// hand가 지워지는 frame을 가리키면 안 됨
+}
+
+/* Sweeps at most two rounds for a frame whose accessed bit is clear,
+ * clearing the bits on the way. */
+static struct frame *
+clock_victim (void) {
+	size_t cnt = 2 * list_size (&clock_list);
+	struct frame *first = NULL;
+
+	for (size_t i = 0; i < cnt; i++) {
+		if (hand == list_end (&clock_list))
+			hand = list_begin (&clock_list);
+		struct frame *frame = list_entry (hand, struct frame, lru_elem);
+		hand = list_next (hand);
+		if (frame->page == NULL)
+			continue;	// caller가 채우는 중인 frame
+		clock_scan_cnt++;
+		if (!vm_frame_accessed (frame))
+			return frame;
+		if (first == NULL)
+			first = frame;
+	}
+	return first;
+}
+
+static void
+clock_print_stats (void) {
+	printf ("Evict: clock, %lld frames scanned\n", clock_scan_cnt);
+}
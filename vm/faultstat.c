@@ -0,0 +1,120 @@
+/* faultstat.c: Page-fault latency histograms.
+ *
+ * vm_try_handle_fault()이 걸린 TSC cycle을 fault 종류별 log2 histogram에
+ * 쌓고, evict도 한 번마다 따로 잰다. 커널 빌드 사이의 VM 성능 변화를 숫자로
+ * 비교하기 위한 것으로, 종료할 때 출력하고 int 0x45로 user program에서도
+ * 읽을 수 있다. -ftrace를 주면 fault마다 한 줄씩 출력해서 utils/fault-replay로
+ * 여러 eviction 정책을 host에서 다시 돌려볼 수 있게 한다. */
+
+#include "vm/faultstat.h"
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+struct fault_hist {
+	long long cnt;							/* 횟수 */
+	uint64_t cycles;						/* 걸린 cycle 합 */
+	long long buckets[FAULTSTAT_BUCKETS];	/* log2 histogram */
+};
+
+static struct fault_hist hists[FAULT_KIND_CNT];
+static enum fault_kind cur_kind;	/* 처리 중인 fault의 종류 (VM lock으로 보호) */
+bool fault_trace;
+
+static const char *kind_names[FAULT_KIND_CNT] = {
+	"minor", "stack", "file", "swap-in", "evict",
+};
+
+static void inspect_faultstat (struct intr_frame *f);
+
+/* Tool for measuring the VM. Calling this function via int 0x45.
+ * Input:
+ *   @RAX - enum fault_kind to inspect
+ *   @RDX - Bucket index, or FAULTSTAT_BUCKETS for the total count, or
+ *          FAULTSTAT_BUCKETS + 1 for the total cycles
+ * Output:
+ *   @RAX - The requested value, or -1 if an input is out of range. */
+void
+faultstat_init (void) {
+	intr_register_int (0x45, 3, INTR_OFF, inspect_faultstat,
+			"Inspect Fault Latency");
+}
+
+uint64_t
+faultstat_now (void) {
+	return rdtsc ();
+}
+
+/* Starts classifying a new fault as minor. Called with the VM lock
+ * held by the outermost fault only. */
+void
+faultstat_begin (void) {
+	cur_kind = FAULT_MINOR;
+}
+
+/* Marks the fault being handled as having taken a step of KIND. */
+void
+faultstat_note (enum fault_kind kind) {
+	if (kind > cur_kind)
+		cur_kind = kind;
+}
+
+/* Records the fault started at START under the kind it was noted as. */
+void
+faultstat_end (uint64_t start) {
+	faultstat_record (cur_kind, start);
+}
+
+/* Prints "FT <tid> <va> <R|W> <kind>" for the fault at VA that was just
+ * handled, if tracing is on. */
+void
+faultstat_trace (const void *va, bool write) {
+	if (fault_trace)
+		printf ("FT %d %p %c %s\n", thread_current ()->tid, va,
+				write ? 'W' : 'R', kind_names[cur_kind]);
+}
+
+/* Records one event of KIND that started at START. */
+void
+faultstat_record (enum fault_kind kind, uint64_t start) {
+	uint64_t cycles = rdtsc () - start;
+	struct fault_hist *h = &hists[kind];
+	int k = 0;
+
+	while (k < FAULTSTAT_BUCKETS - 1 && (cycles >> (k + 1)) != 0)
+		k++;
+	h->cnt++;
+	h->cycles += cycles;
+	h->buckets[k]++;
+}
+
+void
+faultstat_print_stats (void) {
+	printf ("Fault latency (TSC cycles, log2 buckets):\n");
+	for (int i = 0; i < FAULT_KIND_CNT; i++) {
+		struct fault_hist *h = &hists[i];
+		if (h->cnt == 0)
+			continue;
+		printf ("  %-8s %lld events, avg %llu:", kind_names[i], h->cnt,
+				(unsigned long long) (h->cycles / h->cnt));
+		for (int k = 0; k < FAULTSTAT_BUCKETS; k++)
+			if (h->buckets[k] != 0)
+				printf (" 2^%d=%lld", k, h->buckets[k]);
+		printf ("\n");
+	}
+}
+
+static void
+inspect_faultstat (struct intr_frame *f) {
+	uint64_t kind = f->R.rax, idx = f->R.rdx;
+
+	if (kind >= FAULT_KIND_CNT || idx > FAULTSTAT_BUCKETS + 1)
+		f->R.rax = -1;
+	else if (idx == FAULTSTAT_BUCKETS)
+		f->R.rax = hists[kind].cnt;
+	else if (idx == FAULTSTAT_BUCKETS + 1)
+		f->R.rax = hists[kind].cycles;
+	else
+		f->R.rax = hists[kind].buckets[idx];
+}
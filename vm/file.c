@@ -1,8 +1,15 @@
 /* file.c: Implementation of memory backed file object (mmaped object). */
 
 #include "vm/vm.h"
+#include <stdio.h>
+#include <string.h>
+#include "filesys/inode.h"
+#include "threads/malloc.h"
 #include "userprog/process.h"
 #include "threads/mmu.h"
+#include "threads/vaddr.h"
+#include "vm/vma.h"
+#include "vm/faultstat.h"
 //-------project3-swap in out start----------------
 
 //-------project3-swap in out end----------------
@@ -24,7 +31,7 @@ static const struct page_operations file_ops = {
  // - file-backed page와 관련된 것을 setup할 수 있다.
 void vm_file_init(void)
 {
-	
+	// 매핑된 파일 내용은 page cache가 (inode, offset)으로 관리한다 (filesys/page_cache.c)
 }
 
 
@@ -32,34 +39,107 @@ void vm_file_init(void)
 /*  - file-backed page를 초기화한다.
     - file-backed page를 위해 page->operation 안의 handler를 setup한다.
     - page struc의 정보를 업데이트 할 수 있다.  */
-bool file_backed_initializer(struct page *page, enum vm_type type, void *kva)
+bool file_backed_initializer(struct page *page, enum vm_type type UNUSED, void *kva UNUSED)
 {
-	
+	// union이 덮어써지기 전에 mmap_page_create()가 넘겨준 vm_area를 꺼낸다
+	struct vm_area *vma = (struct vm_area *)page->uninit.aux;
+	size_t ofs = page->va - vma->start;
+
 	/* Set up the handler */
 	page->operations = &file_ops;
 	struct file_page *file_page = &page->file;
+	file_page->file = vma->file;
+	file_page->length = ofs >= vma->file_bytes ? 0
+		: vma->file_bytes - ofs < PGSIZE ? vma->file_bytes - ofs : PGSIZE;
+	file_page->offset = vma->offset + ofs;
+	file_page->cache = NULL;
 
 	return true;
 	
 }
 
+//-------project3-shared-mmap-start--------------
+/* Maps the page cache page holding PAGE's part of the file, which every
+ * process mapping the same file shares. PAGE must be a VM_FILE page; if
+ * the prefetch thread gave it a frame while the VM lock was dropped,
+ * nothing is left to do. If the page is not cached yet, it is read from
+ * the file. A frame is only evicted for it if EVICT is true. */
+bool
+mmap_claim(struct page *page, bool evict)
+{
+	if (page->operations->type == VM_UNINIT) {
+		file_backed_initializer(page, page->uninit.type, NULL);
+	}
+	ASSERT(page->operations == &file_ops);
+	if (page->frame != NULL) {
+		return true;	// 앞 page를 읽는 동안 prefetch 스레드가 먼저 매핑했음
+	}
+
+	struct file_page *file_page = &page->file;
+	struct inode *inode = file_get_inode(file_page->file);
+	struct page *cache = page_cache_get(inode, file_page->offset, evict);
+	if (page->frame != NULL) {
+		return true;	// 파일을 읽는 사이 prefetch 스레드가 먼저 매핑했음
+	}
+	if (cache == NULL) {
+		return false;
+	}
+
+	list_push_back(&cache->page_cache.mappers, &file_page->share_elem);
+	file_page->cache = cache;
+	page->frame = cache->frame;
+	if (!vm_install_page(page, cache->frame->kva, page->writable)) {
+		mmap_release(page);
+		return false;
+	}
+	return true;
+}
+
+/* Unmaps PAGE from its page cache page. If this mapping modified the
+ * page, it is written back now; the page itself stays in the cache. */
+void
+mmap_release(struct page *page)
+{
+	struct page *cache = page->file.cache;
+	uint64_t *pml4 = page->owner->pml4;
+
+	if (cache == NULL) {
+		if (page->frame != NULL) {	// mmap_claim()을 거치지 않은 private frame
+			file_backed_swap_out(page);
+			vm_frame_free(page->frame);
+			page->frame = NULL;
+		}
+		return;
+	}
+	if (pml4_is_dirty(pml4, page->va)) {
+		pml4_set_dirty(pml4, page->va, 0);
+		cache->page_cache.dirty = true;
+	}
+	pml4_clear_page(pml4, page->va);
+	list_remove(&page->file.share_elem);
+	page->file.cache = NULL;
+	page->frame = NULL;
+	if (cache->page_cache.dirty) {
+		page_cache_sync(cache);
+	}
+}
+//-------project3-shared-mmap-end----------------
+
 /* Swap in the page by read contents from the file. */
+/* mmap_claim()을 거치지 않고 private frame을 받은 경우에만 쓰인다 */
 static bool
 file_backed_swap_in(struct page *page, void *kva)
 {
-	struct file_page *file_page UNUSED = &page->file;
+	struct file_page *file_page = &page->file;
 	if (page==NULL) {	// page가 NULL이면 종료
-		return NULL;
+		return false;
 	}
 
-	struct container *container = (struct container *)page->uninit.aux;	// page에서 container에서 가져옴
-	struct file *file = container->file;
-	off_t offsetof =container->offset;
-	size_t page_read_bytes = container->page_read_bytes;
+	size_t page_read_bytes = file_page->length;
 	size_t page_zero_bytes = PGSIZE - page_read_bytes;
 	
 	// file에서 frame으로(kva통해서) read하기
-	if(file_read_at(file, kva, page_read_bytes, offsetof) != (int)page_read_bytes) {
+	if(file_read_at(file_page->file, kva, page_read_bytes, file_page->offset) != (int)page_read_bytes) {
 		return false;
 	}
 	memset(kva + page_read_bytes, 0, page_zero_bytes);
@@ -72,20 +152,23 @@ file_backed_swap_in(struct page *page, void *kva)
 static bool
 file_backed_swap_out(struct page *page)
 {
-	struct file_page *file_page UNUSED = &page->file;
+	struct file_page *file_page = &page->file;
 
 	if (page==NULL) {	// page가 NULL이면 종료
-		return NULL;
+		return false;
 	}
 
-	struct container *container = (struct container *)page->uninit.aux;	// page에서 container에서 가져옴
+	// victim은 다른 프로세스의 page일 수도 있으므로 owner의 pml4와 frame의 kva를 쓴다
+	// (page cache를 매핑한 page는 page_cache_drop()이 정리하므로 여기 오지 않음)
+	uint64_t *pml4 = page->owner->pml4;
+	ASSERT(file_page->cache == NULL);
 	// dirtybit가 1인 경우 수정사항을 file에 업데이트(swapout)해준다. 
-	if(pml4_is_dirty(thread_current()->pml4, page->va)) {
-		file_write_at(container->file,page->va, container->page_read_bytes, container->offset);
-		pml4_set_dirty(thread_current()->pml4, page->va, 0);
+	if(pml4_is_dirty(pml4, page->va)) {
+		file_write_at(file_page->file, page->frame->kva, file_page->length, file_page->offset);
+		pml4_set_dirty(pml4, page->va, 0);
 	}
 	// page-frame 연결 해제
-	pml4_clear_page(thread_current()->pml4, page->va);
+	pml4_clear_page(pml4, page->va);
 	return true;
 }
 
@@ -96,102 +179,90 @@ file_backed_swap_out(struct page *page)
 static void
 file_backed_destroy(struct page *page)
 {
-	struct file_page *file_page UNUSED = &page->file;
+	mmap_release(page);
 }
 
 /* Do the mmap */
-/* 가상주소 addr부터 file의 크기만큼 다수의 page를 생성한 뒤, 
-   각 page에 file의 정보를 저장 (file의 offset부터 lenght 크기만큼)
+/* 가상주소 addr부터 length만큼을 file의 offset부터의 내용과 매핑한다.
+   여기서는 vm_area 하나만 기록하고, page는 그 구간에서 처음 fault가 났을 때
+   mmap_page_create()로 만든다. 같은 파일을 mmap한 프로세스들은 fault 시
+   mmap_claim()에서 page cache의 frame을 공유한다.
 */
 void *
 do_mmap(void *addr, size_t length, int writable,
 		struct file *file, off_t offset)
 {
+	struct supplemental_page_table *spt = &thread_current()->spt;
 
+	// 매핑 전체가 유저 영역 안에 있어야 하고, 이미 쓰이는 곳과 겹치면 안 된다
+	if (length > (size_t)((uint8_t *)KERN_BASE - (uint8_t *)addr)) {
+		return NULL;
+	}
+	void *end = pg_round_up(addr + length);
+	if (vma_overlap(&spt->vmas, addr, end) != NULL || !spt_range_empty(spt, addr, end)) {
+		return NULL;
+	}
+
+	struct vm_area *vma = malloc(sizeof *vma);
+	if (vma == NULL) {
+		return NULL;
+	}
 	/* reopen하는 이유: 
 	   file은 이미 open된 상태이며 우리는 그 file을 메모리에 올려주는 작업을 함.
 	   만약 우리가 file에 수정을 하는 작업 도중에 file이 close 되어버렸다면, 수정사항이 disk에 반영되지 않음
 	   따라서 mmap이 실행되고 munmap이 실행되기 전까지 같은 inode를 가진 새로운 file 구조체 만들어서 
 	   이를 open하는 것임
 	*/
-	struct file *mfile = file_reopen(file);
-	void * start_addr = addr; // 시작 주소
-
-	// 파일을 읽고자 하는 크기(length)가 실제 파일의 크기보다 크다면, 실제 파일의 크기만큼만 읽는다.
-	// 반대로, 파일을 읽고자 하는 크기(length)가 실제 파일의 크기보다 작다면, length만큼만 읽는다. 
-	size_t read_bytes = length > file_length(file) ? file_length(file) : length;
-	// PGSIZE 단위로 파일을 다루기 때문에, PGSIZE만큼 못쓰고 남는 부분이 있다면 패딩처리 해준다.
-	size_t zero_bytes = PGSIZE - read_bytes%PGSIZE;
-	
+	vma->file = file_reopen(file);
+	if (vma->file == NULL) {
+		free(vma);
+		return NULL;
+	}
+	// 파일이 매핑보다 짧으면 나머지는 0으로 읽힌다
+	off_t file_left = file_length(file) - offset;
+	vma->start = addr;
+	vma->end = end;
+	vma->offset = offset;
+	vma->file_bytes = file_left <= 0 ? 0 : length < (size_t)file_left ? length : (size_t)file_left;
+	vma->prot = VMA_READ | (writable ? VMA_WRITE : 0);
+	vma->flags = VMA_SHARED;
+	vma_insert(&spt->vmas, vma);
+	return addr;	// 시작 주소를 반환
+}
 
-	/* 파일을 페이지 단위로 잘라 해당 파일의 정보들을 container 구조체에 저장한다.
-	   FILE-BACKED 타입의 UINIT 페이지를 만들어 lazy_load_segment()를 vm_init으로 넣는다. */
-	while(read_bytes > 0 || zero_bytes > 0) {
-		
-		// page_read_bytes만큼 잘라서 읽는다. 
-		size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;	
-		size_t page_zero_bytes = PGSIZE - page_read_bytes;
-		
-		// container에 file 읽기 정보를 넣는다. - 나중에 lazy_load_segment로 넘어감
-		struct container *container = (struct container *)malloc(sizeof(struct container));
-		container->file = mfile;
-		container->page_read_bytes = page_read_bytes;
-		container->offset = offset;
-
-		if (!vm_alloc_page_with_initializer(VM_FILE, addr,
-											writable, lazy_load_segment, container)) {
-			return NULL;
-		}
-		
-		// 읽은 만큼 읽기정보 업데이트
-		read_bytes -= page_read_bytes;
-		zero_bytes -= page_zero_bytes;
-		addr += PGSIZE;
-		offset += page_read_bytes;
-	}
-	thread_current()->mmap_addr = start_addr;	// munmap 확인용 -> 추후 list로 수정 요망
-	return start_addr;	// 시작 주소를 반환
+/* Creates the page at VA, inside VMA of the current process, on its
+ * first fault. Returns the new page, which is not loaded yet, or a null
+ * pointer on failure. */
+struct page *
+mmap_page_create(struct vm_area *vma, void *va)
+{
+	struct supplemental_page_table *spt = &thread_current()->spt;
+
+	if (!vm_alloc_page_with_initializer(VM_FILE, va, (vma->prot & VMA_WRITE) != 0,
+				NULL, vma)) {
+		return NULL;
+	}
+	return spt_find_page(spt, va);
 }
 
 
 /* Do the munmap */
-/* 주어진 가상주소 addr에 해당하는 page에 대해서 frame과의 매핑을 해제함
-   만약 page를 수정했다면, 이를 file에 다시 기록함
+/* 주어진 가상주소 addr에서 시작하는 매핑을 지움. fault가 났던 page만 만들어져 있으므로
+   그 page들만 spt에서 지우고, 수정된 내용은 mmap_release()에서 file에 다시 기록됨
 */
 void do_munmap(void *addr)
 {
-	// 페이지에 연결되어 있는 물리 프레임과의 연결을 끊어준다. 
-	// 유저 가상 메모리의 시작 주소 addr부터 연속으로 나열된 페이지 모두를 매핑 해제한다.
-	// 1. addr 범위의 정해진 주소에 대한 메모리 매핑을 해제한다. (페이지를 지우는 게 아니라 present bit을 0으로 만들어준다)
+	// 1. addr 범위의 정해진 주소에 대한 메모리 매핑을 해제한다.
 	// 2. 이 addr은 반드시 아직 매핑되지 않은 동일한 프로세스에 의한 mmap 호출로부터 반환된 가상주소여야만 한다.
 	// 3. 매핑이 unmapped될 때, 해당 프로세스에 의해 기록된 모든 페이지는 파일에 다시 기록된다.
-
-	// 4. 둘 이상의 프로세스가 동일한 파일을 매핑하는 경우 두 매핑이 동일한 물리 프레임을 공유하는 방식으로 만들어 다룬다
-	// 5. (4)와 연관 그리고 mmap 시스템 호출에는 클라이언트가 페이지를 공유할 것
-
-	// addr가 아직 매핑되지 않은 동일한 프로세스에 의한 mmap 호출로부터 반환된 가상주소인지 체크해주기 
-	if (thread_current()->mmap_addr != addr) {	// 추후 list에서 찾는 것으로 바꿔야 함
-		return NULL;
+	// 4. 둘 이상의 프로세스가 동일한 파일을 매핑하는 경우 두 매핑이 동일한 물리 프레임을 공유한다 (mmap_claim)
+	struct supplemental_page_table *spt = &thread_current()->spt;
+	struct vm_area *vma = vma_find(&spt->vmas, addr);
+	if (vma == NULL || vma->start != addr) {
+		return;
 	}
-	// while문 돌면서 file을 page단위로 page-frame 연결을 해제함
-	while(1) {
-		// addr로 page 찾기
-		struct page* page = spt_find_page(&thread_current()->spt, addr);
-		if (page==NULL) {	// page가 NULL이면 종료
-			return NULL;
-		}
-		struct container *container = (struct container *)page->uninit.aux;	// page에서 container 가져옴
-		
-		// dirty bit가 1이라면(수정했다면) if문 진입 + writable이라면
-		if (pml4_is_dirty(thread_current()->pml4, page->va) && (page->writable == 1)) {	
-			// addr(메모리)에 적힌 내용을 file에 덮어쓰기
-			file_write_at(container->file, addr, container->page_read_bytes, container->offset);	
-			// dirty bit를 다시 0으로 변경
-			pml4_set_dirty(thread_current()->pml4, page->va, 0);
-			
-		}
-		// page-frame 연결 해제
-		pml4_clear_page(thread_current()->pml4, page->va);
-		addr += PGSIZE;	// 다음 페이지로 
-	} 
+
+	vma_remove(&spt->vmas, vma);
+	spt_destroy_range(spt, vma->start, vma->end);	// destroy에서 write back
+	vma_free(vma);
 }
@@ -0,0 +1,95 @@
+/* huge.c: 2MB pages for anonymous regions.
+ *
+ * 2MB로 정렬된 구간의 512 page가 모두 아직 frame이 없는 쓰기 가능한
+ * anonymous page면 그 중 하나에 fault가 났을 때 물리적으로 연속이고 2MB로
+ * 정렬된 512 frame을 한 번에 받아서(필요하면 compaction) 모두 채우고
+ * page table 한 장 대신 PTE_PS가 켜진 PDE 하나로 매핑한다. TLB entry 하나가
+ * 2MB를 덮고 page table page도 하나 아낀다. frame과 struct page는 4KB
+ * 단위 그대로이므로 그 중 한 page만 evict하거나 unmap하는 등 4KB entry를
+ * 고쳐야 하는 순간 mmu.c가 2MB page를 page table로 쪼개고, 그 뒤로는
+ * 평범한 4KB page들이 된다. */
+
+#include "vm/huge.h"
+#include <stdio.h>
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/compact.h"
+#include "vm/vm.h"
+
+#define HUGE_PAGES (HPGSIZE / PGSIZE)	/* 2MB page 하나의 4KB page 수 */
+
+bool huge_pages;
+
+/* Statistics. */
+static long long huge_map_cnt;		/* 2MB page로 매핑한 수 */
+static long long huge_norun_cnt;	/* 연속된 512 frame을 못 구해서 포기한 수 */
+
+static bool huge_eligible (struct thread *t, void *base);
+
+/* Fills the 2MB region around PAGE, which faulted, and maps it with one
+ * 2MB page if every page in it is an anonymous page without a frame.
+ * Returns true if PAGE is mapped now, false to fall back to a 4KB
+ * fault. */
+bool
+huge_fault (struct page *page) {
+	struct thread *curr = thread_current ();
+	void *base = (void *) ((uint64_t) page->va & ~(HPGSIZE - 1));
+
+	if (!huge_eligible (curr, base))
+		return false;
+
+	uint8_t *run = compact_alloc (HUGE_PAGES, HUGE_PAGES);
+	if (run == NULL) {
+		huge_norun_cnt++;
+		return false;
+	}
+
+	size_t i;
+	for (i = 0; i < HUGE_PAGES; i++) {
+		struct page *p = spt_find_page (&curr->spt, base + i * PGSIZE);
+		struct frame *frame = vm_frame_create (run + i * PGSIZE);
+		if (frame == NULL) {
+			palloc_free_page (run + i * PGSIZE);
+			break;
+		}
+		if (!vm_do_claim_frame (p, frame))
+			break;
+	}
+	if (i < HUGE_PAGES) {
+		// 채운 page들은 4KB로 매핑된 채 두고 나머지 frame은 돌려준다
+		for (size_t j = i + 1; j < HUGE_PAGES; j++)
+			palloc_free_page (run + j * PGSIZE);
+		return page->frame != NULL;
+	}
+
+	if (pml4_collapse (curr->pml4, base))
+		huge_map_cnt++;
+	return true;
+}
+
+void
+huge_print_stats (void) {
+	printf ("Huge pages: %lld mapped, %lld fell back for lack of a 2MB run\n",
+			huge_map_cnt, huge_norun_cnt);
+}
+
+/* Returns true if the 2MB region at BASE of T's address space holds
+ * 512 writable anonymous pages, none of them in memory or mapped, and
+ * T's frame quota has room for all of them. Read-only pages are left
+ * alone since they may share frames with other processes. */
+static bool
+huge_eligible (struct thread *t, void *base) {
+	if (t->rss_limit != 0 && t->rss + HUGE_PAGES > t->rss_limit)
+		return false;
+	for (size_t i = 0; i < HUGE_PAGES; i++) {
+		struct page *p = spt_find_page (&t->spt, base + i * PGSIZE);
+		if (p == NULL || !p->writable || p->frame != NULL
+				|| page_get_type (p) != VM_ANON
+				|| pml4_get_page (t->pml4, p->va) != NULL)
+			return false;	// zero page가 매핑된 page도 제외
+	}
+	return true;
+}
@@ -0,0 +1,402 @@
+/* ksm.c: Kernel same-page merging for anonymous memory.
+ *
+ * fork()한 프로세스들이 같은 계산을 하면 supplemental_page_table_copy()가
+ * 복사해준 anonymous page들이 내용까지 똑같은 채로 남는다. memmerge()로
+ * 참여한 프로세스의 page를 ksmd가 돌아가며 checksum하고, 같은 checksum의
+ * page를 찾으면 memcmp로 확인한 뒤 read-only 공유 frame 하나로 합친다.
+ * 합쳐진 page에 쓰면 write fault에서 private frame으로 복사해 갈라진다.
+ *
+ * 두 번 연속 checksum이 같은 (자주 바뀌지 않는) page만 후보가 된다.
+ * 합쳐진 frame은 stable table에, 아직 짝을 못 찾은 후보는 unstable table에
+ * 있고, unstable table은 참여한 프로세스를 한 바퀴 돌 때마다 비운다. */
+
+#include "vm/ksm.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+
+/* A frame shared by identical anonymous pages. */
+struct ksm_node {
+	struct hash_elem elem;		/* stable_table의 element */
+	uint64_t csum;				/* key: 내용의 checksum */
+	struct frame *frame;		/* 공유되는 read-only frame */
+	struct list pages;			/* 이 frame을 매핑한 page들 (항상 2개 이상) */
+	bool indexed;				/* stable_table에 들어 있음 */
+};
+
+bool ksm_enabled;
+
+static struct hash stable_table;	/* ksm_node들 */
+static struct hash unstable_table;	/* 짝을 기다리는 후보 page들 */
+static struct list ksm_procs;		/* memmerge()로 참여한 프로세스들 */
+static size_t round_left;			/* 이번 바퀴에 남은 프로세스 수 */
+
+/* Statistics. */
+static long long scan_cnt;			/* checksum한 page 수 */
+static long long round_cnt;			/* 참여한 프로세스를 다 돈 횟수 */
+static long long merge_cnt;			/* 공유 frame으로 합친 page 수 */
+static long long break_cnt;			/* 쓰기 때문에 다시 갈라진 page 수 */
+static long long node_cnt;			/* 만든 공유 frame 수 */
+
+static void ksmd (void *aux);
+static void scan_process (struct thread *t);
+static void merge_unstable (struct page *page);
+static bool merge_into (struct ksm_node *node, struct page *page);
+static void add_page (struct ksm_node *node, struct page *page);
+static void dissolve (struct ksm_node *node);
+static uint64_t page_checksum (const void *kva);
+static uint64_t node_hash (const struct hash_elem *e, void *aux);
+static bool node_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux);
+static uint64_t cand_hash (const struct hash_elem *e, void *aux);
+static bool cand_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux);
+static void cand_clear (struct hash_elem *e, void *aux);
+
+void
+ksm_init (void) {
+	hash_init (&stable_table, node_hash, node_less, NULL);
+	hash_init (&unstable_table, cand_hash, cand_less, NULL);
+	list_init (&ksm_procs);
+	if (ksm_enabled)
+		thread_create ("ksmd", PRI_DEFAULT, ksmd, NULL);
+}
+
+/* Makes the current process take part in merging if MERGE is true, or
+ * stop if it is false. Pages already merged stay merged until written.
+ * Returns the previous setting. Must be called with the VM lock held. */
+bool
+ksm_set (bool merge) {
+	struct thread *curr = thread_current ();
+	bool old = curr->ksm_merge;
+
+	if (merge != old) {
+		if (old)
+			ksm_leave (curr);
+		curr->ksm_merge = merge;
+		ksm_enter (curr);
+	}
+	return old;
+}
+
+/* Puts T on ksmd's list if T takes part in merging. Called when T gets
+ * a new address space. */
+void
+ksm_enter (struct thread *t) {
+	bool locked = vm_lock_acquire ();
+	if (t->ksm_merge)
+		list_push_back (&ksm_procs, &t->ksm_elem);
+	vm_lock_release (locked);
+}
+
+/* Takes T off ksmd's list before its address space goes away. */
+void
+ksm_leave (struct thread *t) {
+	bool locked = vm_lock_acquire ();
+	if (t->ksm_merge) {
+		list_remove (&t->ksm_elem);
+		if (round_left > list_size (&ksm_procs))
+			round_left = list_size (&ksm_procs);
+	}
+	vm_lock_release (locked);
+}
+
+/* Returns true if PAGE is mapped to a shared ksm frame. */
+bool
+ksm_is_merged (struct page *page) {
+	return page_is_anon (page) && page->anon.ksm != NULL;
+}
+
+/* Handles a write fault on PAGE, a merged page, by giving it a private
+ * copy of the shared frame. */
+bool
+ksm_break (struct page *page) {
+	// frame을 먼저 얻어두고 공유를 푼다. 실패하면 page는 합쳐진 그대로 남는다.
+	struct frame *frame = vm_try_get_frame ();
+	if (frame == NULL) {
+		frame = vm_get_frame ();
+		if (frame == NULL)
+			return false;
+		// vm_get_frame()이 공유 frame을 evict했으면 page는 이미 자기 swap
+		// 자리를 가지므로 보통 page처럼 읽어 들인다
+		if (!ksm_is_merged (page))
+			return vm_do_claim_frame (page, frame);
+	}
+	struct frame *shared = page->frame;
+
+	pml4_clear_page (page->owner->pml4, page->va);
+	memcpy (frame->kva, shared->kva, PGSIZE);
+	ksm_unshare (page);
+
+	vm_frame_set_page (frame, page);
+	page->frame = frame;
+	break_cnt++;
+	return vm_install_page (page, frame->kva, page->writable);
+}
+
+/* Drops PAGE's reference to its shared frame. PAGE must already be
+ * unmapped. The last page left on the frame gets it back as a private,
+ * writable frame. */
+void
+ksm_unshare (struct page *page) {
+	struct ksm_node *node = page->anon.ksm;
+	struct frame *frame = node->frame;
+
+	list_remove (&page->anon.ksm_share_elem);
+	page->anon.ksm = NULL;
+	page->frame = NULL;
+	ASSERT (!list_empty (&node->pages));
+	if (frame->page == page)
+		vm_frame_set_page (frame, list_entry (list_front (&node->pages),
+				struct page, anon.ksm_share_elem));
+	if (list_size (&node->pages) == 1)
+		dissolve (node);
+}
+
+/* Evicts FRAME, a shared ksm frame, by swapping out every page mapped
+ * to it. FRAME itself is left for the caller. */
+void
+ksm_drop (struct frame *frame) {
+	struct ksm_node *node = frame->ksm;
+
+	while (!list_empty (&node->pages)) {
+		struct page *page = list_entry (list_pop_front (&node->pages),
+				struct page, anon.ksm_share_elem);
+		page->anon.ksm = NULL;
+		swap_out (page);	// 각 page가 자기 swap 자리를 가진다
+		page->frame = NULL;
+	}
+	if (node->indexed)
+		hash_delete (&stable_table, &node->elem);
+	frame->ksm = NULL;
+	free (node);
+}
+
+/* Removes PAGE from the unstable table. Called whenever an anonymous
+ * page loses its private frame, so every candidate in the table still
+ * has one. */
+void
+ksm_forget (struct page *page) {
+	if (page_is_anon (page) && page->anon.ksm_unstable) {
+		hash_delete (&unstable_table, &page->anon.ksm_elem);
+		page->anon.ksm_unstable = false;
+	}
+}
+
+/* Returns true if any process accessed FRAME, a shared ksm frame,
+ * since the last call, and clears the accessed bits. */
+bool
+ksm_test_and_clear_accessed (struct frame *frame) {
+	struct ksm_node *node = frame->ksm;
+	bool accessed = false;
+
+	for (struct list_elem *p = list_begin (&node->pages);
+			p != list_end (&node->pages); p = list_next (p)) {
+		struct page *page = list_entry (p, struct page, anon.ksm_share_elem);
+		if (pml4_is_accessed (page->owner->pml4, page->va)) {
+			pml4_set_accessed (page->owner->pml4, page->va, false);
+			accessed = true;
+		}
+	}
+	return accessed;
+}
+
+void
+ksm_print_stats (void) {
+	printf ("KSM: %lld pages scanned in %lld rounds, %lld pages merged into "
+			"%lld frames, %lld broken on write\n", scan_cnt, round_cnt,
+			merge_cnt, node_cnt, break_cnt);
+}
+
+/* Scans one participating process per wakeup, round robin. */
+static void
+ksmd (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (KSM_SLEEP_TICKS);
+
+		bool locked = vm_lock_acquire ();
+		if (!list_empty (&ksm_procs)) {
+			if (round_left == 0) {
+				// 한 바퀴 돌았음: 짝을 못 찾은 후보는 다음 바퀴에 다시 찾는다
+				hash_clear (&unstable_table, cand_clear);
+				round_left = list_size (&ksm_procs);
+				round_cnt++;
+			}
+			struct thread *t = list_entry (list_pop_front (&ksm_procs),
+					struct thread, ksm_elem);
+			list_push_back (&ksm_procs, &t->ksm_elem);
+			round_left--;
+			scan_process (t);
+		}
+		vm_lock_release (locked);
+	}
+}
+
+/* Tries to merge every anonymous page of T that has a private frame. */
+static void
+scan_process (struct thread *t) {
+	struct hash_iterator i;
+
+	hash_first (&i, &t->spt.spt_hash);
+	while (hash_next (&i)) {
+		struct page *page = hash_entry (hash_cur (&i), struct page, hash_elem);
+		struct anon_page *anon = &page->anon;
+
+		if (!page_is_anon (page) || page->frame == NULL || anon->ksm != NULL
+				|| anon->ksm_unstable)
+			continue;
+
+		uint64_t csum = page_checksum (page->frame->kva);
+		scan_cnt++;
+		if (!anon->ksm_seen || anon->ksm_csum != csum) {
+			// 지난번과 내용이 다르면 아직 쓰이고 있는 page다
+			anon->ksm_csum = csum;
+			anon->ksm_seen = true;
+			continue;
+		}
+
+		struct ksm_node key;
+		key.csum = csum;
+		struct hash_elem *e = hash_find (&stable_table, &key.elem);
+		if (e != NULL)
+			merge_into (hash_entry (e, struct ksm_node, elem), page);
+		else
+			merge_unstable (page);
+	}
+}
+
+/* Merges PAGE with a candidate of the same checksum into a new shared
+ * frame, or leaves PAGE as a candidate if there is none. */
+static void
+merge_unstable (struct page *page) {
+	struct hash_elem *e = hash_find (&unstable_table, &page->anon.ksm_elem);
+
+	if (e == NULL) {
+		hash_insert (&unstable_table, &page->anon.ksm_elem);
+		page->anon.ksm_unstable = true;
+		return;
+	}
+
+	struct page *cand = hash_entry (e, struct page, anon.ksm_elem);
+	struct ksm_node *node = malloc (sizeof *node);
+	if (node == NULL)
+		return;
+	ksm_forget (cand);
+
+	// 비교하는 동안 두 프로세스가 쓰지 못하게 매핑을 먼저 내린다
+	pml4_clear_page (cand->owner->pml4, cand->va);
+	pml4_clear_page (page->owner->pml4, page->va);
+	if (memcmp (cand->frame->kva, page->frame->kva, PGSIZE) != 0) {
+		vm_install_page (cand, cand->frame->kva, cand->writable);
+		vm_install_page (page, page->frame->kva, page->writable);
+		free (node);
+		return;
+	}
+
+	struct frame *old = page->frame;
+	node->csum = page->anon.ksm_csum;
+	node->frame = cand->frame;
+	list_init (&node->pages);
+	node->frame->ksm = node;
+	add_page (node, cand);
+	add_page (node, page);
+	vm_frame_free (old);
+	// 같은 checksum의 node가 이미 있으면 (내용이 다르거나 같은 바퀴에 먼저 합쳐진 것)
+	// 이 node는 table에 넣지 않는다. 공유는 되지만 새 page가 찾아오지는 못한다.
+	node->indexed = hash_insert (&stable_table, &node->elem) == NULL;
+	node_cnt++;
+	merge_cnt += 2;
+}
+
+/* Maps PAGE to NODE's frame if their contents are the same, and frees
+ * PAGE's private frame. */
+static bool
+merge_into (struct ksm_node *node, struct page *page) {
+	struct frame *old = page->frame;
+
+	pml4_clear_page (page->owner->pml4, page->va);
+	if (memcmp (old->kva, node->frame->kva, PGSIZE) != 0) {
+		vm_install_page (page, old->kva, page->writable);
+		return false;	// checksum만 같았음
+	}
+	add_page (node, page);
+	vm_frame_free (old);
+	merge_cnt++;
+	return true;
+}
+
+/* Maps PAGE, which is unmapped, read-only to NODE's frame. The PTE is
+ * already there, so installing it cannot fail. Kernel writes to the
+ * page fault as well (CR0.WP), so nobody writes the shared frame. */
+static void
+add_page (struct ksm_node *node, struct page *page) {
+	list_push_back (&node->pages, &page->anon.ksm_share_elem);
+	page->anon.ksm = node;
+	page->frame = node->frame;
+	vm_install_page (page, node->frame->kva, false);
+}
+
+/* Gives NODE's frame back to the only page left on it. */
+static void
+dissolve (struct ksm_node *node) {
+	struct page *last = list_entry (list_pop_front (&node->pages),
+			struct page, anon.ksm_share_elem);
+
+	if (node->indexed)
+		hash_delete (&stable_table, &node->elem);
+	node->frame->ksm = NULL;
+	last->anon.ksm = NULL;
+	pml4_clear_page (last->owner->pml4, last->va);
+	vm_install_page (last, node->frame->kva, last->writable);
+	free (node);
+}
+
+/* 64-bit FNV-1a over the words of the page at KVA. */
+static uint64_t
+page_checksum (const void *kva) {
+	const uint64_t *p = kva;
+	uint64_t h = 0xcbf29ce484222325ULL;
+
+	for (size_t i = 0; i < PGSIZE / sizeof *p; i++)
+		h = (h ^ p[i]) * 0x100000001b3ULL;
+	return h;
+}
+
+static uint64_t
+node_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct ksm_node *n = hash_entry (e, struct ksm_node, elem);
+	return hash_bytes (&n->csum, sizeof n->csum);
+}
+
+static bool
+node_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	return hash_entry (a, struct ksm_node, elem)->csum
+		< hash_entry (b, struct ksm_node, elem)->csum;
+}
+
+static uint64_t
+cand_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct page *p = hash_entry (e, struct page, anon.ksm_elem);
+	return hash_bytes (&p->anon.ksm_csum, sizeof p->anon.ksm_csum);
+}
+
+static bool
+cand_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	return hash_entry (a, struct page, anon.ksm_elem)->anon.ksm_csum
+		< hash_entry (b, struct page, anon.ksm_elem)->anon.ksm_csum;
+}
+
+static void
+cand_clear (struct hash_elem *e, void *aux UNUSED) {
+	hash_entry (e, struct page, anon.ksm_elem)->anon.ksm_unstable = false;
+}
@@ -0,0 +1,75 @@
+/* kswapd.c: Background page-out daemon.
+ *
+ * vm_get_frame()은 user pool이 완전히 비었을 때만 evict하기 때문에
+ * fault를 낸 스레드가 victim 탐색과 swap 쓰기를 직접 기다려야 했다.
+ * kswapd는 남은 frame이 low watermark 아래로 내려가면 깨어나서
+ * high watermark까지 batch 단위로 frame을 미리 비워두고 다시 잔다.
+ * 그래서 대부분의 fault는 palloc에서 바로 frame을 얻는다. */
+
+#include "vm/kswapd.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "vm/vm.h"
+
+static size_t low_wmark;		/* 이보다 적게 남으면 깨어남 */
+static size_t high_wmark;		/* 이만큼 남을 때까지 비움 */
+static struct semaphore kswapd_sema;
+static bool kswapd_awake;
+
+/* Statistics. */
+static long long wakeup_cnt;	/* 깨어난 횟수 */
+static long long reclaim_cnt;	/* 비운 frame 수 */
+static long long written_cnt;	/* 그 중 dirty라서 써야 했던 frame 수 */
+
+static void kswapd (void *aux);
+
+/* Sets the watermarks from the size of the user pool and starts the
+ * daemon. */
+void
+kswapd_init (void) {
+	size_t total = palloc_user_page_cnt ();
+
+	low_wmark = total / 32 > KSWAPD_BATCH / 2 ? total / 32 : KSWAPD_BATCH / 2;
+	high_wmark = low_wmark + KSWAPD_BATCH;
+	sema_init (&kswapd_sema, 0);
+	thread_create ("kswapd", PRI_DEFAULT, kswapd, NULL);
+}
+
+/* Wakes kswapd up if free user frames have dropped below the low
+ * watermark. Called whenever a frame is handed out. */
+void
+kswapd_check (void) {
+	if (!kswapd_awake && palloc_user_free_cnt () < low_wmark) {
+		kswapd_awake = true;
+		sema_up (&kswapd_sema);
+	}
+}
+
+void
+kswapd_print_stats (void) {
+	printf ("Kswapd: watermarks %zu/%zu, %lld wakeups, %lld frames reclaimed, "
+			"%lld written\n", low_wmark, high_wmark, wakeup_cnt, reclaim_cnt,
+			written_cnt);
+}
+
+static void
+kswapd (void *aux UNUSED) {
+	for (;;) {
+		sema_down (&kswapd_sema);
+		wakeup_cnt++;
+		while (palloc_user_free_cnt () < high_wmark) {
+			size_t written = 0;
+			bool locked = vm_lock_acquire ();
+			size_t freed = vm_reclaim (KSWAPD_BATCH, &written);
+			vm_lock_release (locked);
+			if (freed == 0)
+				break;	// 더 비울 frame이 없음
+			reclaim_cnt += freed;
+			written_cnt += written;
+		}
+		kswapd_awake = false;
+	}
+}
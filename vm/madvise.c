@@ -0,0 +1,253 @@
+/* madvise.c: Per-region access hints given by user programs.
+ *
+ * MADV_SEQUENTIAL과 MADV_RANDOM은 spt에 주소 구간별로 저장해두고,
+ * fault가 날 때 madvise_advice()로 찾아서 fault-around 크기를 정한다.
+ * MADV_WILLNEED는 mmap 구간에 아직 없는 page만 만들어두고 prefetch 스레드에
+ * 요청을 넣은 뒤 바로 return 하고,
+ * MADV_DONTNEED는 그 자리에서 frame과 swap 공간을 돌려준다. */
+
+#include "vm/madvise.h"
+#include <debug.h>
+#include <list.h>
+#include <stdio.h>
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+#include "vm/file.h"
+#include "vm/vma.h"
+
+/* Address range [start, end) with a persistent hint. */
+struct madvise_region {
+	void *start;
+	void *end;
+	int advice;					/* MADV_RANDOM or MADV_SEQUENTIAL */
+	struct list_elem elem;		/* spt->madvise_regions의 element (start 순) */
+};
+
+/* MADV_WILLNEED request waiting for the prefetch thread. */
+struct prefetch_req {
+	struct thread *t;			/* 요청한 프로세스 */
+	void *start;
+	void *end;
+	struct list_elem elem;
+};
+
+static struct list prefetch_queue;
+static struct semaphore prefetch_sema;
+static struct prefetch_req *prefetch_cur;	/* 처리 중인 요청 */
+
+/* Statistics. */
+static long long prefetch_cnt;	/* WILLNEED로 미리 올린 페이지 수 */
+static long long dontneed_cnt;	/* DONTNEED로 버린 페이지 수 */
+
+static void set_region (struct supplemental_page_table *spt, void *start,
+		void *end, int advice);
+static void prefetch_thread (void *aux);
+
+void
+madvise_init (void) {
+	list_init (&prefetch_queue);
+	sema_init (&prefetch_sema, 0);
+	thread_create ("prefetch", PRI_DEFAULT, prefetch_thread, NULL);
+}
+
+/* Applies ADVICE to the pages in [ADDR, ADDR + LENGTH) of the current
+ * process. Returns 0 on success, -1 if the range or advice is invalid. */
+int
+do_madvise (void *addr, size_t length, int advice) {
+	struct thread *curr = thread_current ();
+	struct supplemental_page_table *spt = &curr->spt;
+	void *end = pg_round_up (addr + length);
+
+	if (addr == NULL || pg_ofs (addr) != 0 || length == 0
+			|| !is_user_vaddr (addr) || end <= addr || !is_user_vaddr (end - 1))
+		return -1;
+
+	bool locked = vm_lock_acquire ();
+	switch (advice) {
+		case MADV_NORMAL:
+		case MADV_RANDOM:
+		case MADV_SEQUENTIAL:
+			set_region (spt, addr, end, advice);
+			break;
+		case MADV_WILLNEED: {
+			// mmap 구간의 page는 첫 fault 때 만들어지므로, prefetch 스레드가 찾을 수
+			// 있게 여기서 (요청한 프로세스의 spt에) 만들어둔다
+			for (void *va = addr; va < end; va += PGSIZE) {
+				struct vm_area *vma = vma_find (&spt->vmas, va);
+				if (vma != NULL && spt_find_page (spt, va) == NULL)
+					mmap_page_create (vma, va);
+			}
+			struct prefetch_req *req = malloc (sizeof *req);
+			if (req == NULL) {
+				vm_lock_release (locked);
+				return -1;
+			}
+			req->t = curr;
+			req->start = addr;
+			req->end = end;
+			list_push_back (&prefetch_queue, &req->elem);
+			sema_up (&prefetch_sema);
+			break;
+		}
+		case MADV_DONTNEED:
+			for (void *va = addr; va < end; va += PGSIZE) {
+				struct page *page = spt_find_page (spt, va);
+				if (page != NULL && vm_page_discard (page))
+					dontneed_cnt++;
+			}
+			break;
+		default:
+			vm_lock_release (locked);
+			return -1;
+	}
+	vm_lock_release (locked);
+	return 0;
+}
+
+/* Returns the persistent hint for VA in SPT, MADV_NORMAL if none. */
+int
+madvise_advice (struct supplemental_page_table *spt, void *va) {
+	struct list_elem *e;
+
+	for (e = list_begin (&spt->madvise_regions);
+			e != list_end (&spt->madvise_regions); e = list_next (e)) {
+		struct madvise_region *r = list_entry (e, struct madvise_region, elem);
+		if (va < r->start)
+			break;
+		if (va < r->end)
+			return r->advice;
+	}
+	return MADV_NORMAL;
+}
+
+/* Copies the hints of SRC into DST for fork(). */
+bool
+madvise_copy (struct supplemental_page_table *dst,
+		struct supplemental_page_table *src) {
+	struct list_elem *e;
+
+	for (e = list_begin (&src->madvise_regions);
+			e != list_end (&src->madvise_regions); e = list_next (e)) {
+		struct madvise_region *r = list_entry (e, struct madvise_region, elem);
+		struct madvise_region *copy = malloc (sizeof *copy);
+		if (copy == NULL)
+			return false;
+		*copy = *r;
+		list_push_back (&dst->madvise_regions, &copy->elem);
+	}
+	return true;
+}
+
+/* Frees the hints of SPT and cancels its owner's pending prefetches.
+ * Must be called with the VM lock held. */
+void
+madvise_kill (struct supplemental_page_table *spt) {
+	struct list_elem *e;
+
+	while (!list_empty (&spt->madvise_regions))
+		free (list_entry (list_pop_front (&spt->madvise_regions),
+					struct madvise_region, elem));
+
+	for (e = list_begin (&prefetch_queue); e != list_end (&prefetch_queue);) {
+		struct prefetch_req *req = list_entry (e, struct prefetch_req, elem);
+		if (&req->t->spt == spt) {
+			e = list_remove (e);
+			free (req);
+		} else
+			e = list_next (e);
+	}
+	if (prefetch_cur != NULL && &prefetch_cur->t->spt == spt)
+		prefetch_cur = NULL;	// prefetch 스레드가 보고 멈춘다
+}
+
+void
+madvise_print_stats (void) {
+	printf ("Madvise: %lld pages prefetched, %lld pages dropped\n",
+			prefetch_cnt, dontneed_cnt);
+}
+
+/* Sets the hint for [START, END) to ADVICE, trimming or splitting the
+ * regions it overlaps. MADV_NORMAL just removes the old hints. */
+static void
+set_region (struct supplemental_page_table *spt, void *start, void *end,
+		int advice) {
+	struct list *regions = &spt->madvise_regions;
+	struct list_elem *e;
+
+	for (e = list_begin (regions); e != list_end (regions);) {
+		struct madvise_region *r = list_entry (e, struct madvise_region, elem);
+		if (r->end <= start || end <= r->start) {
+			e = list_next (e);
+			continue;
+		}
+		if (r->start < start && end < r->end) {
+			// 가운데가 뚫리는 경우: 뒤쪽 조각을 새로 만든다
+			struct madvise_region *tail = malloc (sizeof *tail);
+			if (tail != NULL) {
+				*tail = *r;
+				tail->start = end;
+				list_insert (list_next (e), &tail->elem);
+			}
+			r->end = start;
+			break;
+		}
+		if (r->start < start)
+			r->end = start;
+		else if (end < r->end)
+			r->start = end;
+		else {
+			e = list_remove (e);
+			free (r);
+			continue;
+		}
+		e = list_next (e);
+	}
+
+	if (advice == MADV_NORMAL)
+		return;
+	struct madvise_region *r = malloc (sizeof *r);
+	if (r == NULL)
+		return;
+	r->start = start;
+	r->end = end;
+	r->advice = advice;
+	for (e = list_begin (regions); e != list_end (regions); e = list_next (e))
+		if (start < list_entry (e, struct madvise_region, elem)->start)
+			break;
+	list_insert (e, &r->elem);
+}
+
+/* Serves MADV_WILLNEED requests in the background. Only free frames are
+ * used, so prefetching never pushes other pages out, and the VM lock is
+ * dropped between pages so that page faults are not held up. */
+static void
+prefetch_thread (void *aux UNUSED) {
+	for (;;) {
+		sema_down (&prefetch_sema);
+		bool locked = vm_lock_acquire ();
+		if (list_empty (&prefetch_queue)) {
+			vm_lock_release (locked);
+			continue;
+		}
+		struct prefetch_req *req = list_entry (list_pop_front (&prefetch_queue),
+				struct prefetch_req, elem);
+		prefetch_cur = req;
+		for (void *va = req->start; va < req->end && prefetch_cur != NULL;
+				va += PGSIZE) {
+			struct page *page = spt_find_page (&req->t->spt, va);
+			if (page != NULL && page->frame == NULL) {
+				if (!vm_prefetch_page (page))
+					break;	// 남는 frame이 없음
+				prefetch_cnt++;
+			}
+			vm_lock_release (locked);
+			locked = vm_lock_acquire ();
+		}
+		prefetch_cur = NULL;
+		free (req);
+		vm_lock_release (locked);
+	}
+}
@@ -0,0 +1,165 @@
+/* mglru.c: Multi-generational LRU eviction policy.
+ *
+ * frame을 나이(generation)별 list로 나눈다. 새로 채운 frame과 최근에 쓰인
+ * frame은 가장 젊은 generation(max_seq)에, evict는 가장 늙은 generation
+ * (min_seq)에서 한다. clock처럼 frame마다 주인의 page table을 찾아가는 대신
+ * 늙은 generation이 바닥나면 max_seq를 올리고(aging) 모든 주소 공간의 user
+ * page table을 처음부터 끝까지 차례로 훑어서 accessed bit가 켜진 frame을 새
+ * generation으로 옮긴다. page table 한 장의 pte 512개를 연달아 보기 때문에
+ * frame list를 따라 여기저기 pml4를 walk하는 것보다 훨씬 싸다. */
+
+#include <debug.h>
+#include <list.h>
+#include <stdio.h>
+#include "threads/mmu.h"
+#include "threads/pte.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/evict.h"
+#include "vm/vm.h"
+
+/* Number of generation lists. At most three are in use at once. */
+#define MGLRU_GENS 4
+
+static struct list gens[MGLRU_GENS];	/* seq % MGLRU_GENS번 generation */
+static unsigned long min_seq;		/* 가장 늙은 generation */
+static unsigned long max_seq;		/* 가장 젊은 generation */
+static size_t frame_cnt;			/* list에 있는 frame 수 */
+
+/* Statistics. */
+static long long age_cnt;			/* aging 횟수 */
+static long long pte_scan_cnt;		/* aging에서 본 pte 수 */
+static long long promote_cnt;		/* aging에서 젊은 generation으로 옮긴 frame 수 */
+static long long rescue_cnt;		/* evict 직전에 accessed라서 살려준 frame 수 */
+
+static void mglru_init (void);
+static void mglru_add (struct frame *frame);
+static void mglru_remove (struct frame *frame);
+static struct frame *mglru_victim (void);
+static void mglru_print_stats (void);
+static void move_young (struct frame *frame);
+static void age (void);
+static bool age_space (struct thread *t, void *aux);
+static bool age_pte (uint64_t *pte, void *va, void *aux);
+
+const struct evict_policy mglru_policy = {
+	.name = "mglru",
+	.init = mglru_init,
+	.add = mglru_add,
+	.remove = mglru_remove,
+	.victim = mglru_victim,
+	.print_stats = mglru_print_stats,
+};
+
+static void
+mglru_init (void) {
+	for (int i = 0; i < MGLRU_GENS; i++)
+		list_init (&gens[i]);
+	min_seq = 0;
+	max_seq = 1;
+}
+
+static void
+mglru_add (struct frame *frame) {
+	frame->gen = max_seq;
+	list_push_back (&gens[max_seq % MGLRU_GENS], &frame->lru_elem);
+	frame_cnt++;
+}
+
+static void
+mglru_remove (struct frame *frame) {
+	list_remove (&frame->lru_elem);
+	frame_cnt--;
+}
+
+/* Takes frames off the oldest generation until one was not accessed
+ * since it was last looked at. Frames being filled and accessed frames
+ * move to the youngest generation, and so does the victim, since the
+ * caller fills it again. Ages when the oldest generations run out. */
+static struct frame *
+mglru_victim (void) {
+	size_t budget = 2 * frame_cnt + 2 * MGLRU_GENS;
+	struct frame *first = NULL;
+
+	while (budget-- > 0) {
+		struct list *oldest = &gens[min_seq % MGLRU_GENS];
+		if (list_empty (oldest)) {
+			if (max_seq - min_seq < 2)
+				age ();	// generation이 두 개 이하로 줄면 새 generation을 만든다
+			min_seq++;
+			continue;
+		}
+
+		struct frame *frame = list_entry (list_front (oldest), struct frame,
+				lru_elem);
+		move_young (frame);
+		if (frame->page == NULL)
+			continue;	// caller가 채우는 중인 frame
+		if (!vm_frame_accessed (frame))
+			return frame;
+		rescue_cnt++;
+		if (first == NULL)
+			first = frame;
+	}
+	return first;
+}
+
+static void
+mglru_print_stats (void) {
+	printf ("Evict: mglru, %lld agings, %lld ptes scanned, %lld promoted, "
+			"%lld rescued\n", age_cnt, pte_scan_cnt, promote_cnt, rescue_cnt);
+}
+
+static void
+move_young (struct frame *frame) {
+	list_remove (&frame->lru_elem);
+	frame->gen = max_seq;
+	list_push_back (&gens[max_seq % MGLRU_GENS], &frame->lru_elem);
+}
+
+/* Opens a new youngest generation and moves every frame some process
+ * touched since the last aging into it, clearing the accessed bits. */
+static void
+age (void) {
+	ASSERT (max_seq - min_seq + 1 < MGLRU_GENS);
+
+	max_seq++;
+	age_cnt++;
+	vm_for_each_space (age_space, NULL);
+}
+
+/* age_pte()는 pte를 직접 고치므로 TLB는 주소 공간마다 한 번에 비운다. */
+static bool
+age_space (struct thread *t, void *aux UNUSED) {
+	bool cleared = false;
+
+	if (t->pml4 != NULL) {	// exec() 도중에는 pml4가 없음
+		pml4_for_each_user (t->pml4, age_pte, &cleared);
+		if (cleared)
+			pml4_flush (t->pml4);
+	}
+	return true;
+}
+
+/* A 2MB page has one accessed bit, so all 512 frames under it count as
+ * accessed. Sets *CLEARED if the accessed bit was cleared. */
+static bool
+age_pte (uint64_t *pte, void *va UNUSED, void *cleared) {
+	size_t cnt = *pte & PTE_PS ? HPGSIZE / PGSIZE : 1;
+
+	pte_scan_cnt++;
+	if ((*pte & PTE_A) == 0)
+		return true;
+
+	uint8_t *kva = ptov (PTE_ADDR (*pte));
+	*pte &= ~(uint64_t) PTE_A;
+	*(bool *) cleared = true;
+	for (size_t i = 0; i < cnt; i++) {
+		struct frame *frame = vm_frame_lookup (kva + i * PGSIZE);
+		if (frame != NULL && frame->gen != max_seq) {
+			move_young (frame);
+			promote_cnt++;
+		}
+	}
+	return true;
+}
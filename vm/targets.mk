@@ -2,4 +2,15 @@ vm_SRC = vm/vm.c          # Main api proxy
 vm_SRC += vm/uninit.c     # Uninitialized page
 vm_SRC += vm/anon.c       # Anonymous page
 vm_SRC += vm/file.c       # File mapped page
+vm_SRC += vm/vma.c        # Mapped region interval tree
+vm_SRC += vm/zswap.c      # Compressed swap cache
+vm_SRC += vm/text.c       # Shared read-only text pages
+vm_SRC += vm/madvise.c    # madvise() hints and prefetch thread
+vm_SRC += vm/kswapd.c     # Background page-out daemon
+vm_SRC += vm/faultstat.c  # Fault latency histograms
+vm_SRC += vm/ksm.c        # Same-page merging daemon
+vm_SRC += vm/evict.c      # Eviction policy selection and clock
+vm_SRC += vm/mglru.c      # Multi-generational LRU policy
+vm_SRC += vm/compact.c    # Physical memory compaction
+vm_SRC += vm/huge.c       # 2MB pages for anonymous regions
 vm_SRC += vm/inspect.c    # Testing utility
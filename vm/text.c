@@ -0,0 +1,275 @@
+/* text.c: Read-only segment pages shared across processes.
+ *
+ * load_segment()은 모든 segment를 각 프로세스의 private page로 만들기 때문에
+ * 같은 프로그램을 여러 개 띄우면 code가 프로세스 수만큼 RAM에 올라간다.
+ * 쓰기가 불가능한 segment page는 (inode, offset)을 key로 하는 cache에서
+ * frame을 찾아 refcount를 올려 같이 매핑하고, 처음 보는 page만 파일에서 읽는다.
+ * 이 frame들은 항상 깨끗하므로 evict 될 때 swap 하지 않고 그냥 버린다. */
+
+#include "vm/text.h"
+#include <debug.h>
+#include <hash.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
+#include "userprog/process.h"
+#include "vm/vm.h"
+#include "vm/faultstat.h"
+
+/* One shared frame. */
+struct text_entry {
+	struct hash_elem elem;		/* text_table의 element */
+	struct inode *inode;		/* key: 실행 파일의 inode */
+	off_t offset;				/* key: 파일 안의 위치 */
+	size_t read_bytes;			/* key: 파일에서 읽는 길이 (나머지는 0) */
+	struct frame *frame;		/* 공유되는 frame */
+	struct list pages;			/* 이 frame을 매핑한 page들 */
+};
+
+/* text_table과 각 entry의 pages를 보호한다. 파일을 읽거나 frame을 구하는
+ * 동안에는 잡지 않는다 (frame을 구하다가 text_drop()으로 들어올 수 있다). */
+static struct hash text_table;
+static struct lock text_lock;
+
+/* Statistics. */
+static long long load_cnt;		/* 파일에서 새로 읽은 frame 수 */
+static long long share_cnt;		/* 이미 있는 frame을 같이 매핑한 fault 수 */
+static long long drop_cnt;		/* swap 없이 버린 frame 수 */
+
+static bool text_swap_in (struct page *page, void *kva);
+static bool text_swap_out (struct page *page);
+static void text_destroy (struct page *page);
+static uint64_t text_hash (const struct hash_elem *e, void *aux);
+static bool text_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux);
+
+static const struct page_operations text_ops = {
+	.swap_in = text_swap_in,
+	.swap_out = text_swap_out,
+	.destroy = text_destroy,
+	.type = VM_ANON,
+};
+
+void
+vm_text_init (void) {
+	hash_init (&text_table, text_hash, text_less, NULL);
+	lock_init (&text_lock);
+}
+
+/* Returns true if PAGE is a not-yet-loaded, read-only executable
+ * segment page that can share its frame with other processes. */
+bool
+page_is_shareable (struct page *page) {
+	return page->operations->type == VM_UNINIT
+		&& page->uninit.init == lazy_load_segment
+		&& VM_TYPE (page->uninit.type) == VM_ANON
+		&& !page->writable;
+}
+
+bool
+page_is_text (struct page *page) {
+	return page->operations == &text_ops;
+}
+
+/* Maps the shared frame for PAGE, which must be shareable or an already
+ * converted text page without a frame. If no process has the frame yet,
+ * a new one is read from the file. A frame is only evicted for it if
+ * EVICT is true. */
+bool
+text_claim (struct page *page, bool evict) {
+	if (page->operations->type == VM_UNINIT) {
+		// container는 fork된 자식과 같이 쓰므로 free하지 않는다
+		struct container *aux = page->uninit.aux;
+		page->operations = &text_ops;
+		page->text.aux = aux;
+		page->text.entry = NULL;
+	}
+	ASSERT (page_is_text (page));
+	ASSERT (page->frame == NULL);
+
+	struct container *aux = page->text.aux;
+	struct text_entry key, *e;
+	struct hash_elem *found;
+
+	key.inode = file_get_inode (aux->file);
+	key.offset = aux->offset;
+	key.read_bytes = aux->page_read_bytes;
+	lock_acquire (&text_lock);
+	found = hash_find (&text_table, &key.elem);
+	if (found != NULL) {
+		e = hash_entry (found, struct text_entry, elem);
+		share_cnt++;
+	} else {
+		lock_release (&text_lock);
+		struct frame *frame = evict ? vm_get_frame () : vm_try_get_frame ();
+		if (frame == NULL)
+			return false;
+		faultstat_note (FAULT_FILE);
+		if (file_read_at (aux->file, frame->kva, aux->page_read_bytes,
+					aux->offset) != (off_t) aux->page_read_bytes) {
+			vm_frame_free (frame);
+			return false;
+		}
+		memset (frame->kva + aux->page_read_bytes, 0,
+				PGSIZE - aux->page_read_bytes);
+
+		e = malloc (sizeof *e);
+		if (e == NULL) {
+			vm_frame_free (frame);
+			return false;
+		}
+		*e = key;
+		e->frame = frame;
+		list_init (&e->pages);
+
+		// 읽는 사이 다른 프로세스가 같은 page를 올렸으면 그 frame을 같이 쓴다
+		lock_acquire (&text_lock);
+		found = hash_insert (&text_table, &e->elem);
+		if (found != NULL) {
+			free (e);
+			vm_frame_free (frame);
+			e = hash_entry (found, struct text_entry, elem);
+			share_cnt++;
+		} else {
+			frame->text = e;
+			vm_frame_set_page (frame, page);
+			load_cnt++;
+		}
+	}
+
+	list_push_back (&e->pages, &page->text.share_elem);
+	page->text.entry = e;
+	page->frame = e->frame;
+	lock_release (&text_lock);
+	if (!vm_install_page (page, e->frame->kva, false)) {
+		pml4_clear_page (page->owner->pml4, page->va);
+		text_unshare (page);
+		return false;
+	}
+	return true;
+}
+
+/* Drops PAGE's reference to its shared frame. PAGE must already be
+ * unmapped. The frame is freed with the last reference. */
+void
+text_unshare (struct page *page) {
+	struct text_entry *e = page->text.entry;
+	struct frame *frame = e->frame;
+
+	lock_acquire (&text_lock);
+	list_remove (&page->text.share_elem);
+	page->text.entry = NULL;
+	page->frame = NULL;
+	if (!list_empty (&e->pages)) {
+		if (frame->page == page)
+			vm_frame_set_page (frame, list_entry (list_front (&e->pages),
+					struct page, text.share_elem));
+		lock_release (&text_lock);
+		return;
+	}
+
+	hash_delete (&text_table, &e->elem);
+	frame->text = NULL;
+	free (e);
+	vm_frame_free (frame);
+	lock_release (&text_lock);
+}
+
+/* Unmaps FRAME, a shared text frame chosen for eviction, from every
+ * process. Nothing is written anywhere: the next fault reads the page
+ * from the executable again. FRAME itself is left for the caller. */
+void
+text_drop (struct frame *frame) {
+	struct text_entry *e = frame->text;
+
+	lock_acquire (&text_lock);
+	while (!list_empty (&e->pages)) {
+		struct page *page = list_entry (list_pop_front (&e->pages),
+				struct page, text.share_elem);
+		pml4_clear_page (page->owner->pml4, page->va);
+		page->text.entry = NULL;
+		page->frame = NULL;
+	}
+	hash_delete (&text_table, &e->elem);
+	free (e);
+	frame->text = NULL;
+	drop_cnt++;
+	lock_release (&text_lock);
+}
+
+/* Returns true if any process accessed FRAME, a shared text frame,
+ * since the last call, and clears the accessed bits. */
+bool
+text_test_and_clear_accessed (struct frame *frame) {
+	struct text_entry *e = frame->text;
+	bool accessed = false;
+
+	lock_acquire (&text_lock);
+	for (struct list_elem *p = list_begin (&e->pages); p != list_end (&e->pages);
+			p = list_next (p)) {
+		struct page *page = list_entry (p, struct page, text.share_elem);
+		if (pml4_is_accessed (page->owner->pml4, page->va)) {
+			pml4_set_accessed (page->owner->pml4, page->va, false);
+			accessed = true;
+		}
+	}
+	lock_release (&text_lock);
+	return accessed;
+}
+
+void
+text_print_stats (void) {
+	printf ("Text: %lld frames loaded, %lld faults shared, %lld frames dropped\n",
+			load_cnt, share_cnt, drop_cnt);
+}
+
+/* A text page that ended up with a private frame (e.g. claimed through
+ * vm_do_claim_page()) is simply read from the executable. */
+static bool
+text_swap_in (struct page *page, void *kva) {
+	struct container *aux = page->text.aux;
+
+	if (file_read_at (aux->file, kva, aux->page_read_bytes, aux->offset)
+			!= (off_t) aux->page_read_bytes)
+		return false;
+	memset (kva + aux->page_read_bytes, 0, PGSIZE - aux->page_read_bytes);
+	return true;
+}
+
+/* Read-only pages are never dirty, so there is nothing to save. */
+static bool
+text_swap_out (struct page *page) {
+	pml4_clear_page (page->owner->pml4, page->va);
+	return true;
+}
+
+/* Drops PAGE's reference to the shared frame, if it still has one. */
+static void
+text_destroy (struct page *page) {
+	if (page->text.entry != NULL) {
+		pml4_clear_page (page->owner->pml4, page->va);
+		text_unshare (page);
+	}
+}
+
+static uint64_t
+text_hash (const struct hash_elem *e_, void *aux UNUSED) {
+	const struct text_entry *e = hash_entry (e_, struct text_entry, elem);
+	return hash_bytes (&e->inode, sizeof e->inode) ^ hash_int (e->offset);
+}
+
+static bool
+text_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct text_entry *a = hash_entry (a_, struct text_entry, elem);
+	const struct text_entry *b = hash_entry (b_, struct text_entry, elem);
+
+	if (a->inode != b->inode)
+		return a->inode < b->inode;
+	if (a->offset != b->offset)
+		return a->offset < b->offset;
+	return a->read_bytes < b->read_bytes;
+}
@@ -1,18 +1,58 @@
 /* vm.c: Generic interface for virtual memory objects. */
 
+#include <stdio.h>
+#include <string.h>
 #include "threads/malloc.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
+#include "vm/zswap.h"
+#include "vm/madvise.h"
+#include "vm/kswapd.h"
+#include "vm/faultstat.h"
+#include "vm/ksm.h"
+#include "vm/evict.h"
+#include "vm/compact.h"
+#include "vm/huge.h"
 #include "lib/kernel/hash.h"
 #include "include/threads/thread.h"
 #include "userprog/process.h"
 #include "threads/vaddr.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
 
 //-------project3-memory_management-start--------------
 struct list frame_table;	// frame_table을 전역으로 선언함
-struct list_elem *clock_start;	// frame_table의 시작 elem
+static struct frame **frame_map;	// pool page 번호 -> frame (page table을 훑어서 찾은 kva용)
+static struct list vm_spaces;	// 주소 공간이 있는 프로세스들 (vm_elem)
+static struct lock vm_lock;	// page fault와 prefetch 스레드가 frame_table, spt를 같이 건드리지 않도록
 //-------project3-memory_management-end----------------
 
+//-------project3-fault-around-start--------------
+/* 파일에서 lazy load 되는 페이지에 fault가 나면 뒤따르는 페이지들까지
+   한 번의 file_read_at으로 읽어서 같이 매핑한다. 커널 옵션 -fa=N으로 조절, 0이면 끔 */
+size_t fault_around_pages = 16;
+static long long fault_around_cnt;		// 여러 페이지를 한 번에 읽은 fault 수
+static long long fault_around_mapped;	// 미리 매핑해서 아낀 fault 수
+//-------project3-fault-around-end----------------
+
+//-------project3-rss-limit-start--------------
+/* 각 frame은 frame->page의 주인 프로세스에 charge되고 (thread->rss),
+   rss_limit를 넘은 프로세스는 새 frame 대신 자기 frame을 evict해서 쓴다.
+   그래서 메모리를 많이 쓰는 프로세스가 다른 프로세스의 working set을 밀어내지 않는다.
+   커널 옵션 -rss=N이 기본값, 0이면 제한 없음. fork하면 물려받고 exec해도 유지된다 */
+size_t rss_limit_default;
+static long long quota_evict_cnt;	// quota 때문에 자기 frame을 evict한 수
+//-------project3-rss-limit-end----------------
+
+//-------project3-zero-page-start--------------
+/* 한 번도 쓰지 않은 anonymous page(BSS, 새 stack 등)를 읽기만 하면
+   frame을 새로 주지 않고 모든 프로세스가 공유하는 0 frame을 read-only로 매핑한다.
+   처음 쓰는 순간 write fault가 나면 그때 private frame을 준다. */
+static void *zero_kva;				// 공유 zero frame (kernel pool, frame_table에 없음)
+static long long zero_map_cnt;		// zero page로 처리한 read fault 수
+static long long zero_copy_cnt;		// 쓰기 때문에 private frame을 준 수
+//-------project3-zero-page-end----------------
+
 /* Initializes the virtual memory subsystem by invoking
  * intialize codes. */
 void vm_init(void)
@@ -25,7 +65,62 @@ void vm_init(void)
 	register_inspect_intr();
 	/* DO NOT MODIFY UPPER LINES. */
 	/* TODO: Your code goes here. */
+#ifndef EFILESYS
+	page_cache_init();	// project 3에서도 mmap한 파일은 page cache를 거친다
+#endif
 	list_init(&frame_table); // frame_table 리스트를 초기화
+	list_init(&vm_spaces);
+	frame_map = calloc(palloc_page_cnt(), sizeof *frame_map);
+	ASSERT(frame_map != NULL);
+	evict_policy->init();
+	lock_init(&vm_lock);
+	zero_kva = palloc_get_page(PAL_ASSERT | PAL_ZERO);
+	vm_text_init();
+	madvise_init();
+	kswapd_init();
+	faultstat_init();
+	ksm_init();
+}
+
+/* Acquires the VM lock unless the current thread already holds it, which
+ * happens when a page fault is raised while the kernel is touching user
+ * memory with the lock held (e.g. in supplemental_page_table_copy()). */
+bool vm_lock_acquire(void)
+{
+	if (lock_held_by_current_thread(&vm_lock)) {
+		return false;
+	}
+	lock_acquire(&vm_lock);
+	return true;
+}
+
+void vm_lock_release(bool locked)
+{
+	if (locked) {
+		lock_release(&vm_lock);
+	}
+}
+
+/* Prints statistics about the virtual memory subsystem. */
+void vm_print_stats(void)
+{
+	printf("Fault-around: %lld batched faults, %lld pages mapped ahead\n",
+			fault_around_cnt, fault_around_mapped);
+	printf("Zero page: %lld read faults mapped, %lld private frames on write\n",
+			zero_map_cnt, zero_copy_cnt);
+	printf("RSS limit: default %zu frames, %lld own-frame evictions\n",
+			rss_limit_default, quota_evict_cnt);
+	evict_policy->print_stats();
+	compact_print_stats();
+	huge_print_stats();
+	text_print_stats();
+	page_cache_print_stats();
+	anon_print_stats();
+	zswap_print_stats();
+	madvise_print_stats();
+	kswapd_print_stats();
+	ksm_print_stats();
+	faultstat_print_stats();
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -45,9 +140,22 @@ page_get_type(struct page *page)
 }
 
 /* Helpers */
-static struct frame *vm_get_victim(void);
+static struct frame *vm_get_own_victim(struct thread *t);
+static struct frame *vm_reclaim_own(struct thread *t);
+static struct frame *vm_alloc_frame(void);
+static bool vm_over_quota(struct thread *t);
 static bool vm_do_claim_page(struct page *page);
 static struct frame *vm_evict_frame(void);
+static void vm_evict(struct frame *victim);
+static bool vm_frame_dirty(struct frame *frame);
+static bool vm_handle_fault(struct intr_frame *f, void *addr, bool user, bool write, bool not_present);
+static bool page_is_file_lazy(struct page *page);
+static bool vm_fault_around(struct page *page);
+static bool page_is_zero_fill(struct page *page);
+static bool vm_zero_mapped(struct page *page);
+static bool vm_map_zero(struct page *page);
+static bool vm_zero_write(struct page *page);
+static bool vm_vma_fault(struct vm_area *vma, void *va);
 
 /* Create the pending page object with initializer. If you want to create a
  * page, do not create it directly and make it through this function or
@@ -92,6 +200,7 @@ bool vm_alloc_page_with_initializer(enum vm_type type, void *upage, bool writabl
 		// uninit_new에게 인자로 받아온 type에 따라 다른 인자들을 넘겨주어, page 구조체에 넣는다.
 		uninit_new(page, upage, init, type, aux, initializer);
 		page->writable = writable;
+		page->owner = thread_current();
 		
 		// TODO: Insert the page into the spt.
 		return spt_insert_page(spt, page);	// spt에 page를 넣는다
@@ -103,16 +212,21 @@ err:
 /* Find VA from spt and return page. On error, return NULL. */
 // 인자로 받은 va(가상 주소)에 해당하는 페이지 번호를 spt에서 검색하여 적절한 page를 찾는 함수
 struct page *
-spt_find_page(struct supplemental_page_table *spt UNUSED, void *va UNUSED)
+spt_find_page(struct supplemental_page_table *spt, void *va)
 // va를 기준으로 hash_table에서 elem을 찾는다
 // va를 통해 page structure의 시작 주소를 구함
 {
 	/* TODO: Fill this function. */
 	//-------project3-memory_management-start--------------
-	struct page *page = page_lookup(va); 
+	// prefetch 스레드는 다른 프로세스의 spt에서 찾으므로 인자로 받은 spt를 쓴다
+	struct page p;
+	struct hash_elem *e;
+
+	p.va = pg_round_down(va);
+	e = hash_find(&spt->spt_hash, &p.hash_elem);
 	//-------project3-memory_management-end----------------
 	
-	return page;
+	return e != NULL ? hash_entry(e, struct page, hash_elem) : NULL;
 }
 
 //-------project3-memory_management-start--------------
@@ -161,6 +275,72 @@ bool spt_delete_page(struct supplemental_page_table *spt, struct page *page)
 	return false;
 }
 
+/* Returns true if SPT has no page in [START, END). Probes every address
+ * or walks the whole table, whichever is shorter. */
+bool spt_range_empty(struct supplemental_page_table *spt, void *start, void *end)
+{
+	if ((size_t)(end - start) / PGSIZE <= hash_size(&spt->spt_hash)) {
+		for (void *va = start; va < end; va += PGSIZE) {
+			if (spt_find_page(spt, va) != NULL) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	struct hash_iterator i;
+	hash_first(&i, &spt->spt_hash);
+	while (hash_next(&i)) {
+		struct page *page = hash_entry(hash_cur(&i), struct page, hash_elem);
+		if (start <= page->va && page->va < end) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Removes and frees every page of SPT in [START, END). Like
+ * spt_range_empty(), a large range with few pages is handled by walking
+ * the table instead of probing each address. */
+void spt_destroy_range(struct supplemental_page_table *spt, void *start, void *end)
+{
+	size_t range = (size_t)(end - start) / PGSIZE;
+	size_t n = hash_size(&spt->spt_hash);
+	struct page **victims = NULL;
+
+	if (n == 0) {
+		return;
+	}
+	if (n < range) {
+		victims = malloc(n * sizeof *victims);
+	}
+	if (victims == NULL) {
+		for (void *va = start; va < end; va += PGSIZE) {
+			struct page *page = spt_find_page(spt, va);
+			if (page != NULL) {
+				spt_delete_page(spt, page);
+				vm_dealloc_page(page);
+			}
+		}
+		return;
+	}
+
+	// hash를 도는 중에는 지울 수 없으므로 모아뒀다가 지운다
+	struct hash_iterator i;
+	size_t cnt = 0;
+	hash_first(&i, &spt->spt_hash);
+	while (hash_next(&i)) {
+		struct page *page = hash_entry(hash_cur(&i), struct page, hash_elem);
+		if (start <= page->va && page->va < end) {
+			victims[cnt++] = page;
+		}
+	}
+	for (size_t k = 0; k < cnt; k++) {
+		spt_delete_page(spt, victims[k]);
+		vm_dealloc_page(victims[k]);
+	}
+	free(victims);
+}
 //-------project3-memory_management-end----------------
 
 void spt_remove_page(struct supplemental_page_table *spt, struct page *page)
@@ -168,36 +348,29 @@ void spt_remove_page(struct supplemental_page_table *spt, struct page *page)
 	vm_dealloc_page(page);
 }
 
-/* Get the struct frame, that will be evicted. */
-static struct frame *
-vm_get_victim(void)
+/* Returns true if FRAME was accessed since the last check and clears
+ * the accessed bit, looking at the page table of every process that
+ * maps it. */
+bool
+vm_frame_accessed(struct frame *frame)
 {
-	struct frame *victim = NULL;
-	/* TODO: The policy for eviction is up to you. */
-
-	// 내가만든 clock정책
-	struct thread *curr = thread_current();
-    struct list_elem *e = clock_start;
-    for (clock_start = e; clock_start != list_end(&frame_table); clock_start = list_next(clock_start)) {
-        victim = list_entry(clock_start, struct frame, frame_elem);
-		bool succ = pml4_is_accessed(curr->pml4, victim->page->va);
-		if (succ) {
-            pml4_set_accessed (curr->pml4, victim->page->va, 0);
-		}	
-        else {
-            return victim;
-		}
-    }
-
-    for (clock_start = list_begin(&frame_table); clock_start != e; clock_start = list_next(clock_start)) {
-        victim = list_entry(clock_start, struct frame, frame_elem);
-        if (pml4_is_accessed(curr->pml4, victim->page->va))
-            pml4_set_accessed (curr->pml4, victim->page->va, 0);
-        else
-            return victim;
-    }
+	if (frame->text != NULL) {
+		return text_test_and_clear_accessed(frame);
+	}
+	if (frame->ksm != NULL) {
+		return ksm_test_and_clear_accessed(frame);
+	}
 
-	return victim;
+	struct page *page = frame->page;
+	if (page->operations->type == VM_PAGE_CACHE) {
+		return page_cache_test_and_clear_accessed(frame);
+	}
+	uint64_t *pml4 = page->owner->pml4;	// victim은 다른 프로세스의 page일 수도 있음
+	if (pml4_is_accessed(pml4, page->va)) {
+		pml4_set_accessed(pml4, page->va, 0);
+		return true;
+	}
+	return false;
 }
 
 /* Evict one page and return the corresponding frame.
@@ -205,59 +378,353 @@ vm_get_victim(void)
 static struct frame *
 vm_evict_frame(void)
 {
-	struct frame *victim UNUSED = vm_get_victim();
+	struct frame *victim = evict_policy->victim();
 	/* TODO: swap out the victim and return the evicted frame. */
+	if (victim == NULL) {
+		return NULL;
+	}
+	vm_evict(victim);
+	return victim;
+}
+
+/* Swaps out the page in VICTIM, or unmaps every process from a shared
+ * text frame, leaving VICTIM unused but still in the frame table. */
+static void
+vm_evict(struct frame *victim)
+{
 	// 비우고자 하는 해당 프레임을 victim이라 하고, 
 	// 이 victim과 연결된 가상 페이지를 swap_out()에 인자로 넣어준다.
+	uint64_t start = faultstat_now();
 	
-	swap_out(victim->page);
-
-	victim->page = NULL;
+	if (victim->text != NULL) {
+		text_drop(victim);	// 공유 text frame은 깨끗하므로 swap 없이 버린다
+	}
+	else if (victim->ksm != NULL) {
+		ksm_drop(victim);	// 합쳐진 page들을 각자 swap out
+	}
+	else if (victim->page->operations->type == VM_PAGE_CACHE) {
+		page_cache_drop(victim);	// write back하고 매핑한 프로세스들에서 모두 뗀다
+	}
+	else {
+		swap_out(victim->page);
+		victim->page->frame = NULL;	// 쫓겨난 page는 더 이상 이 frame을 가리키면 안 됨
+	}
+	vm_frame_set_page(victim, NULL);
+	faultstat_record(FAULT_EVICT, start);
 	// memset(victim->kva, 0, PGSIZE);
+}
 
-	return victim;
+/* Returns true if evicting FRAME has to write its contents somewhere.
+ * Shared text frames never do. */
+static bool
+vm_frame_dirty(struct frame *frame)
+{
+	if (frame->text != NULL) {
+		return false;
+	}
+	if (frame->ksm != NULL) {
+		return true;	// read-only로 매핑되어 dirty bit가 없지만 어딘가에 써야 함
+	}
+	if (frame->page->operations->type == VM_PAGE_CACHE) {
+		return page_cache_is_dirty(frame);
+	}
+	return pml4_is_dirty(frame->page->owner->pml4, frame->page->va);
+}
+
+/* Evicts up to CNT frames chosen by the eviction policy and returns them to the
+ * user pool. Dirty victims are written out first, then the clean ones
+ * are dropped. Returns the number of frames freed and stores how many
+ * were dirty in *WRITTEN. Must be called with the VM lock held. */
+size_t
+vm_reclaim(size_t cnt, size_t *written)
+{
+	struct frame *batch[KSWAPD_BATCH];
+	bool dirty[KSWAPD_BATCH];
+	size_t n = 0;
+
+	ASSERT(cnt <= KSWAPD_BATCH);
+	while (n < cnt && !list_empty(&frame_table)) {
+		struct frame *victim = evict_policy->victim();
+		size_t i;
+		if (victim == NULL) {
+			break;
+		}
+		for (i = 0; i < n && batch[i] != victim; i++)
+			continue;
+		if (i < n) {
+			break;	// 정책이 한 바퀴 돌아 같은 frame으로 돌아옴
+		}
+		dirty[n] = vm_frame_dirty(victim);
+		batch[n++] = victim;
+	}
+
+	*written = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (dirty[i]) {
+			vm_evict(batch[i]);
+			(*written)++;
+		}
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (!dirty[i]) {
+			vm_evict(batch[i]);
+		}
+		vm_frame_free(batch[i]);
+	}
+	return n;
 }
 
 //-------project3-memory_management-start--------------
 /* palloc() and get frame. If there is no available page, evict the page
- * and return it. This always return valid address. That is, if the user pool
- * memory is full, this function evicts the frame to get the available memory
- * space.*/
+ * and return it. If the user pool memory is full, this function evicts the
+ * frame to get the available memory space. Returns NULL when every frame is
+ * pinned (page == NULL) and the policy finds no victim.*/
 /* user pool에서 새로운 physical page를 palloc_get_page()를 통해 얻어오는 함수
    그리고 이를 물리 메모리의 frame과 연결
    만약 가용 가능한 페이지가 없다면 victim 페이지를 스왑하여 frame 공간을 디스크로 내린다.
 */
-static struct frame *
+struct frame *
 vm_get_frame (void) {
-	// 새로운 frame 만들기
-	struct frame *frame = (struct frame *)malloc(sizeof(struct frame));
-
-	// physical memory의 user pool에서 1page를 할당하고, 이에 해당하는 kva를 반환
-	frame->kva = palloc_get_page(PAL_USER);	// 새로 만든 frame과 새로 할당받은 page를 연결
+	// quota를 넘었으면 자기 frame부터 비워서 쓴다
+	struct frame *frame = vm_reclaim_own(thread_current());
 
-	if (frame->kva == NULL) // 유저 풀 공간이 하나도 없다면
+	if (frame == NULL) {
+		frame = vm_alloc_frame();
+	}
+	if (frame == NULL) // 유저 풀 공간이 하나도 없다면
 	{
 		frame = vm_evict_frame(); // 새로운 프레임을 할당
 		return frame;
 	}
+	ASSERT(frame != NULL);
+	ASSERT(frame->page == NULL);
+
+	return frame;
+}
+
+/* Allocates a frame from the user pool without evicting anything.
+ * Returns NULL if the user pool is exhausted or the current process is
+ * at its frame quota. */
+struct frame *
+vm_try_get_frame (void) {
+	if (vm_over_quota(thread_current())) {
+		return NULL;
+	}
+	return vm_alloc_frame();
+}
+
+static struct frame *
+vm_alloc_frame(void)
+{
+	// physical memory의 user pool에서 1page를 할당하고, 이에 해당하는 kva를 반환
+	void *kva = palloc_get_page(PAL_USER);
+	if (kva == NULL) {
+		return NULL;
+	}
+
+	struct frame *frame = vm_frame_create(kva);
+	if (frame == NULL) {
+		palloc_free_page(kva);
+	}
+	return frame;
+}
+
+/* Puts the user pool page at KVA, which the caller has allocated, in
+ * the frame table as an unused frame. Returns NULL if out of memory. */
+struct frame *
+vm_frame_create(void *kva)
+{
+	// 새로운 frame 만들기
+	struct frame *frame = (struct frame *)malloc(sizeof(struct frame));
+	if (frame == NULL) {
+		return NULL;
+	}
+	frame->kva = kva;	// 새로 만든 frame과 새로 할당받은 page를 연결
 	list_push_back(&frame_table, &frame->frame_elem);	// frame table 리스트에 frame elem을 넣음
-	clock_start = &frame->frame_elem;	// evict frame 정책이 clock이라서
+	frame_map[palloc_page_idx(kva)] = frame;
 
 	frame->page = NULL;	// frame의 page멤버 초기화
-	ASSERT(frame != NULL);
-	ASSERT(frame->page == NULL);
+	frame->text = NULL;
+	frame->ksm = NULL;
+	evict_policy->add(frame);
+	kswapd_check();	// 남은 frame이 적으면 kswapd가 미리 비워둔다
+	return frame;
+}
+
+/* Removes FRAME from the frame table and returns its memory to the
+ * user pool. FRAME must not be mapped by any page. */
+void
+vm_frame_free (struct frame *frame) {
+	vm_frame_set_page(frame, NULL);
+	evict_policy->remove(frame);
+	list_remove(&frame->frame_elem);
+	frame_map[palloc_page_idx(frame->kva)] = NULL;
+	palloc_free_page(frame->kva);
+	free(frame);
+}
 
+/* Returns the frame whose memory is at KVA, or NULL if KVA is not a
+ * user frame in the frame table, e.g. the shared zero frame. */
+struct frame *
+vm_frame_lookup(void *kva)
+{
+	size_t idx = palloc_page_idx(kva);
+	return idx != SIZE_MAX ? frame_map[idx] : NULL;
+}
+
+/* Moves FRAME to the user pool page at KVA, which the caller has
+ * allocated and filled. The caller also fixes up the page tables and
+ * frees the old page. */
+void
+vm_frame_move(struct frame *frame, void *kva)
+{
+	frame_map[palloc_page_idx(frame->kva)] = NULL;
+	frame_map[palloc_page_idx(kva)] = frame;
+	frame->kva = kva;
+}
+
+/* Calls FUNC on every process that has an address space, with the VM
+ * lock held. Stops early if FUNC returns false. */
+void
+vm_for_each_space(bool (*func)(struct thread *, void *), void *aux)
+{
+	struct list_elem *e;
+
+	for (e = list_begin(&vm_spaces); e != list_end(&vm_spaces); e = list_next(e)) {
+		if (!func(list_entry(e, struct thread, vm_elem), aux)) {
+			break;
+		}
+	}
+}
+
+/* Points FRAME at PAGE, moving the frame's charge from the owner of the
+ * old page to the owner of PAGE. Either may be NULL, and page cache
+ * pages have no owner to charge. */
+void
+vm_frame_set_page(struct frame *frame, struct page *page)
+{
+	if (frame->page != NULL && frame->page->owner != NULL) {
+		frame->page->owner->rss--;
+	}
+	if (page != NULL && page->owner != NULL) {
+		page->owner->rss++;
+	}
+	frame->page = page;
+}
+
+/* Sets the current process's frame quota to FRAMES, 0 meaning no
+ * limit, and evicts its frames down to the new quota right away.
+ * Returns the old quota. Must be called with the VM lock held. */
+size_t
+vm_set_rss_limit(size_t frames)
+{
+	struct thread *curr = thread_current();
+	size_t old = curr->rss_limit;
+
+	curr->rss_limit = frames;
+	if (frames != 0 && curr->rss > frames) {
+		curr->rss_limit = frames + 1;	// 한도 아래가 아니라 한도까지만 비운다
+		struct frame *frame = vm_reclaim_own(curr);
+		if (frame != NULL) {
+			vm_frame_free(frame);
+		}
+		curr->rss_limit = frames;
+	}
+	return old;
+}
+
+/* Returns true if T holds as many frames as its quota allows. */
+static bool
+vm_over_quota(struct thread *t)
+{
+	return t->rss_limit != 0 && t->rss >= t->rss_limit;
+}
+
+/* Evicts T's own frames until T is below its quota and returns the
+ * last one, still in the frame table, for T to reuse. Returns NULL if
+ * T is within its quota or has nothing left to evict. */
+static struct frame *
+vm_reclaim_own(struct thread *t)
+{
+	struct frame *frame = NULL;
+
+	while (vm_over_quota(t)) {
+		if (frame != NULL) {
+			vm_frame_free(frame);	// quota가 줄어든 경우: 한도 아래로 갈 때까지 돌려준다
+		}
+		frame = vm_get_own_victim(t);
+		if (frame == NULL) {
+			break;
+		}
+		vm_evict(frame);
+		quota_evict_cnt++;
+	}
 	return frame;
 }
+
+/* Second-chance scan over the frames charged to T. Returns the first
+ * one not accessed since the last scan, or else the first one seen,
+ * whose accessed bit has been cleared by now. */
+static struct frame *
+vm_get_own_victim(struct thread *t)
+{
+	struct frame *first = NULL;
+
+	for (struct list_elem *e = list_begin(&frame_table); e != list_end(&frame_table); e = list_next(e)) {
+		struct frame *frame = list_entry(e, struct frame, frame_elem);
+		if (frame->page == NULL || frame->page->owner != t) {
+			continue;
+		}
+		if (!vm_frame_accessed(frame)) {
+			return frame;
+		}
+		if (first == NULL) {
+			first = frame;
+		}
+	}
+	return first;
+}
+
+/* Unmaps PAGE from its owner and releases its frame, or its reference to
+ * a shared frame. Clearing the PTE first also keeps pml4_destroy() from
+ * freeing the frame a second time. mmap pages are written back first. */
+void
+vm_free_frame(struct page *page)
+{
+	struct frame *frame = page->frame;
+
+	if (page->operations->type == VM_FILE) {
+		mmap_release(page);
+		return;
+	}
+	pml4_clear_page(page->owner->pml4, page->va);
+	if (frame->text != NULL) {
+		text_unshare(page);
+		return;
+	}
+	if (frame->ksm != NULL) {
+		ksm_unshare(page);
+		return;
+	}
+	ksm_forget(page);
+	page->frame = NULL;
+	vm_frame_free(frame);
+}
 //-------project3-memory_management-end----------------
 
 /* Growing the stack. */
 static void 
-vm_stack_growth(void *addr UNUSED)
+vm_stack_growth(void *addr UNUSED, bool write)
 {	
 	// 페이지 할당받기 
 	if (vm_alloc_page(VM_ANON | VM_MARKER_0, addr, 1)) {    // type, upage, writable
-		vm_claim_page(addr);	// 페이지 claim
+		faultstat_note(FAULT_STACK);
+		if (write) {
+			vm_claim_page(addr);	// 페이지 claim
+		}
+		else {
+			vm_map_zero(spt_find_page(&thread_current()->spt, addr));	// 읽기만 하면 zero page
+		}
 		thread_current()->stack_bottom -= PGSIZE;
     }
 }
@@ -272,6 +739,23 @@ vm_handle_wp(struct page *page UNUSED)
 // page fault는 user program이 진행되면서 program이 물리 메모리에 있을거라고 생각하면서
 // 접근 하는데 실제로는 원하는 데이터가 물리 메모리에 load 혹은 저장되어있지 않을 경우 발생함
 bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED, bool user UNUSED, bool write UNUSED, bool not_present UNUSED)
+{
+	uint64_t start = faultstat_now();	// lock을 기다린 시간도 fault 처리 시간에 넣는다
+	bool locked = vm_lock_acquire();
+	if (locked) {
+		faultstat_begin();	// 안쪽 fault(spt copy 중 등)는 바깥 fault의 일부로 센다
+	}
+	bool success = vm_handle_fault(f, addr, user, write, not_present);
+	if (locked && success) {
+		faultstat_end(start);
+		faultstat_trace(addr, write);
+	}
+	vm_lock_release(locked);
+	return success;
+}
+
+static bool
+vm_handle_fault(struct intr_frame *f, void *addr, bool user UNUSED, bool write, bool not_present)
 { 	
 	struct supplemental_page_table *spt UNUSED = &thread_current()->spt;
 	struct page *page = NULL;
@@ -287,10 +771,30 @@ bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED, bool us
 		// 커널이면 thread구조체의 rsp_stack을, 유저면 interrupt frame의 rsp를 사용함
    	 	void *rsp_stack = is_kernel_vaddr(f->rsp) ? thread_current()->rsp_stack : f->rsp;
 
+		// 파일에서 lazy load 되는 페이지라면 주변 페이지까지 한 번에 읽어온다
+		// (read-only segment는 그 안에서 다른 프로세스와 frame을 공유함)
+		page = spt_find_page(spt, addr);
+		if (page != NULL && huge_pages && huge_fault(page)) {
+			return true;	// 주변 2MB를 한 번에 채워서 2MB page로 매핑함
+		}
+		if (page == NULL) {
+			// mmap한 구간이면 page를 이제 만든다
+			struct vm_area *vma = vma_find(&spt->vmas, addr);
+			if (vma != NULL) {
+				return vm_vma_fault(vma, pg_round_down(addr));
+			}
+		}
+		if (page != NULL && !write && page_is_zero_fill(page)) {
+			return vm_map_zero(page);
+		}
+		if (page != NULL && page_is_file_lazy(page)) {
+			return vm_fault_around(page);
+		}
+
         if (!vm_claim_page(addr)) {	// page를 새로 할당받지 못하는 경우 진입
 			// 유저 스택영역에 접근하는 경우임, 참고: 0x100000 = 2^20 = 1MB 
             if (rsp_stack - 8 <= addr && USER_STACK - 0x100000 <= addr && addr <= USER_STACK) { 
-                vm_stack_growth(pg_round_down(addr));	
+                vm_stack_growth(pg_round_down(addr), write);	
                 return true;
             }
             return false;
@@ -298,10 +802,277 @@ bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED, bool us
         else
             return true;
     }
+	// zero page가 매핑된 page에 처음 쓰는 경우
+	page = spt_find_page(spt, addr);
+	if (write && page != NULL && page->writable && vm_zero_mapped(page)) {
+		return vm_zero_write(page);
+	}
+	// 다른 page와 합쳐진 page에 쓰는 경우
+	if (write && page != NULL && page->writable && ksm_is_merged(page)) {
+		return ksm_break(page);
+	}
     return false;
 	// --------------------project3 Anonymous Page end----------
 }
 
+//-------project3-fault-around-start--------------
+/* Returns true if PAGE has not been loaded yet and will be read from a
+ * file by lazy_load_segment() (executable segments and mmaped files). */
+static bool
+page_is_file_lazy(struct page *page)
+{
+	return page->operations->type == VM_UNINIT
+		&& page->uninit.init == lazy_load_segment;
+}
+
+/* Clears the accessed bits of the pages a sequential reader of VA left
+ * behind, between one and two windows back, so the clock hand takes
+ * them before pages that are still in use. */
+static void
+vm_age_behind(void *va)
+{
+	struct thread *curr = thread_current();
+	size_t span = FAULT_AROUND_MAX * PGSIZE;
+
+	if ((uintptr_t)va < 2 * span) {
+		return;
+	}
+	for (void *p = va - 2 * span; p < va - span; p += PGSIZE) {
+		struct page *page = spt_find_page(&curr->spt, p);
+		if (page != NULL && page->frame != NULL) {
+			pml4_set_accessed(curr->pml4, p, 0);
+		}
+	}
+}
+
+/* Picks how many pages to read for a fault on VA and remembers where a
+ * sequential reader would fault next. The window doubles while faults
+ * keep landing right after the last batch and halves otherwise.
+ * madvise() hints override this: no fault-around for MADV_RANDOM and
+ * the largest window for MADV_SEQUENTIAL. */
+static size_t
+fault_around_window(void *va)
+{
+	struct thread *curr = thread_current();
+	size_t max = fault_around_pages < FAULT_AROUND_MAX
+			? fault_around_pages : FAULT_AROUND_MAX;
+
+	switch (madvise_advice(&curr->spt, va)) {
+		case MADV_RANDOM:
+			return 1;
+		case MADV_SEQUENTIAL:
+			vm_age_behind(va);
+			return FAULT_AROUND_MAX;
+		default:
+			break;
+	}
+	if (max <= 1) {
+		return 1;
+	}
+	if (curr->fa_window == 0) {
+		curr->fa_window = max < 4 ? max : 4;	// 처음에는 작게 시작
+	}
+	else if (va == curr->fa_next) {
+		curr->fa_window = curr->fa_window * 2 < max ? curr->fa_window * 2 : max;
+	}
+	else if (curr->fa_window > 1) {
+		curr->fa_window /= 2;
+	}
+	return curr->fa_window < max ? curr->fa_window : max;
+}
+
+/* Maps PAGE and frame at the same time, then transmutes PAGE into its
+ * real type. The contents are already in FRAME, so the page's own
+ * lazy_load_segment() is skipped. If PAGE cannot be mapped, FRAME is
+ * freed and PAGE is left without a frame. */
+static bool
+vm_map_loaded_page(struct page *page, struct frame *frame)
+{
+	vm_frame_set_page(frame, page);
+	page->frame = frame;
+	if (!vm_install_page(page, frame->kva, page->writable)) {
+		// 예: 이미 zero page가 매핑된 BSS page. frame을 물려야 다음 fault가 제대로 처리된다
+		page->frame = NULL;
+		vm_frame_free(frame);
+		return false;
+	}
+	return page->uninit.page_initializer(page, page->uninit.type, frame->kva);
+}
+
+/* Handles a fault on PAGE, a lazily loaded file page, by loading it
+ * together with the pages that follow it in the same file, each read
+ * straight into its own frame, and mapping all of them. Falls back to
+ * the normal one-page claim whenever batching is not possible. */
+static bool
+vm_fault_around(struct page *page)
+{
+	struct supplemental_page_table *spt = &thread_current()->spt;
+	struct page *run[FAULT_AROUND_MAX];
+	struct container *first = page->uninit.aux;
+	size_t window = fault_around_window(page->va);
+	size_t n = 1;
+
+	// 파일에서 바로 이어지는 위치를 읽는 페이지들만 모은다
+	run[0] = page;
+	while (n < window) {
+		struct container *prev = run[n - 1]->uninit.aux;
+		if (prev->page_read_bytes != PGSIZE) {
+			break;	// 마지막 페이지(뒤쪽은 0)까지 왔음
+		}
+		struct page *next = spt_find_page(spt, run[n - 1]->va + PGSIZE);
+		if (next == NULL || !page_is_file_lazy(next)) {
+			break;
+		}
+		struct container *c = next->uninit.aux;
+		if (c->file != first->file || c->offset != prev->offset + PGSIZE) {
+			break;
+		}
+		if (c->page_read_bytes == 0) {
+			break;	// 읽을 것이 없는 BSS page는 zero page로 처리된다
+		}
+		run[n++] = next;
+	}
+	thread_current()->fa_next = run[n - 1]->va + PGSIZE;
+	if (n == 1) {
+		return vm_claim_page(page->va);
+	}
+
+	// fault 난 페이지는 evict을 해서라도 frame을 얻고,
+	// 나머지는 남는 frame이 있을 때만 미리 매핑한다.
+	// 공유 page는 text_claim()/mmap_claim()이 이미 올라온 frame을 쓰거나 직접 읽는다.
+	bool success = false;
+	for (size_t i = 0; i < n; i++) {
+		if (page_is_shareable(run[i])) {
+			if (!text_claim(run[i], i == 0)) {
+				break;
+			}
+		}
+		else if (page_get_type(run[i]) == VM_FILE) {
+			if (!mmap_claim(run[i], i == 0)) {
+				break;
+			}
+		}
+		else {
+			struct container *c = run[i]->uninit.aux;
+			struct frame *frame = i == 0 ? vm_get_frame() : vm_try_get_frame();
+			if (frame == NULL) {
+				break;
+			}
+			if (file_read_at(c->file, frame->kva, c->page_read_bytes, c->offset)
+					!= (off_t)c->page_read_bytes) {
+				vm_frame_free(frame);
+				break;
+			}
+			memset(frame->kva + c->page_read_bytes, 0, PGSIZE - c->page_read_bytes);
+			if (i == 0) {
+				faultstat_note(FAULT_FILE);
+			}
+			if (!vm_map_loaded_page(run[i], frame)) {
+				break;
+			}
+		}
+		if (i == 0) {
+			success = true;
+		}
+		else {
+			fault_around_mapped++;
+		}
+	}
+	fault_around_cnt++;
+	return success;
+}
+
+/* Handles the first fault at VA inside VMA, where no page exists yet,
+ * by creating the page and mapping its shared frame. The pages after it
+ * in the mapping that were never touched either are mapped along with
+ * it, as long as free frames are left. */
+static bool
+vm_vma_fault(struct vm_area *vma, void *va)
+{
+	struct supplemental_page_table *spt = &thread_current()->spt;
+	size_t window = fault_around_window(va);
+	bool success = false;
+
+	for (size_t i = 0; i < window && va < vma->end; i++, va += PGSIZE) {
+		if (i > 0 && spt_find_page(spt, va) != NULL) {
+			break;
+		}
+		struct page *page = mmap_page_create(vma, va);
+		if (page == NULL || !mmap_claim(page, i == 0)) {
+			break;	// 만들어진 page는 다음 fault에서 vm_claim_page()로 올라온다
+		}
+		if (i == 0) {
+			success = true;
+		}
+		else {
+			fault_around_mapped++;
+		}
+	}
+	thread_current()->fa_next = va;
+	return success;
+}
+//-------project3-fault-around-end----------------
+
+//-------project3-zero-page-start--------------
+/* Returns true if PAGE has no frame and is known to read as all zeros:
+ * a fresh anonymous page, a BSS page with nothing to read from the
+ * executable, or an anonymous page that was evicted while zero. */
+static bool
+page_is_zero_fill(struct page *page)
+{
+	if (page->operations->type != VM_UNINIT) {
+		return anon_is_zero(page);
+	}
+	if (VM_TYPE(page->uninit.type) != VM_ANON) {
+		return false;
+	}
+	if (page->uninit.init == NULL) {
+		return true;
+	}
+	return page->uninit.init == lazy_load_segment
+		&& ((struct container *)page->uninit.aux)->page_read_bytes == 0;
+}
+
+/* Returns true if PAGE is currently mapped to the shared zero frame. */
+static bool
+vm_zero_mapped(struct page *page)
+{
+	return page->frame == NULL
+		&& pml4_get_page(page->owner->pml4, page->va) == zero_kva;
+}
+
+/* Maps the shared zero frame read-only at PAGE. PAGE itself stays as it
+ * is, so a later write fault still loads it the normal way. */
+static bool
+vm_map_zero(struct page *page)
+{
+	if (!vm_install_page(page, zero_kva, false)) {
+		return false;
+	}
+	zero_map_cnt++;
+	return true;
+}
+
+/* Handles the first write to PAGE, which is mapped to the zero frame,
+ * by giving it a private frame. */
+static bool
+vm_zero_write(struct page *page)
+{
+	// init이 없는 anonymous page는 frame을 0으로 채워주지 않으므로 직접 채운다
+	bool fresh = page->operations->type == VM_UNINIT && page->uninit.init == NULL;
+
+	pml4_clear_page(page->owner->pml4, page->va);
+	if (!vm_claim_page(page->va)) {
+		return false;
+	}
+	if (fresh) {
+		memset(page->frame->kva, 0, PGSIZE);
+	}
+	zero_copy_cnt++;
+	return true;
+}
+//-------project3-zero-page-end----------------
+
 /* Free the page.
  * DO NOT MODIFY THIS FUNCTION. */
 void vm_dealloc_page(struct page *page)
@@ -320,15 +1091,80 @@ bool vm_claim_page(void *va UNUSED)
 { 
 	struct page *page = NULL;
 	struct thread *curr = thread_current();
+	bool locked, success;
 	/* TODO: Fill this function */
 	page = spt_find_page(&curr->spt, va); // 먼저 spt에서 va에 해당하는 page를 가져온다
 
 	if (page == NULL) {
 		return false;
 	}
-
+	locked = vm_lock_acquire();
+	// read-only segment는 같은 실행 파일을 쓰는 프로세스와 frame을 공유한다
+	if (page_is_shareable(page) || page_is_text(page)) {
+		success = text_claim(page, true);
+	}
+	// mmap한 페이지는 같은 파일을 mmap한 프로세스와 frame을 공유한다
+	else if (page_get_type(page) == VM_FILE) {
+		success = mmap_claim(page, true);
+	}
 	// 물리 frame을 새로 할당받고 이를 인자로 넘겨준 page와 연결함, 또한 page table entry에 해당 정보를 매핑함
-	return vm_do_claim_page(page); 
+	else {
+		success = vm_do_claim_page(page);
+	}
+	vm_lock_release(locked);
+	return success;
+}
+
+/* Loads PAGE, which may belong to another process, using only a free
+ * frame. Returns false without touching PAGE if the user pool is full,
+ * so prefetching never evicts anything. */
+bool vm_prefetch_page(struct page *page)
+{
+	if (vm_zero_mapped(page)) {
+		return true;	// 읽기에는 이미 충분함
+	}
+	if (vm_over_quota(page->owner)) {
+		return false;	// 미리 읽느라 quota를 넘기지 않는다
+	}
+	if (page_is_shareable(page) || page_is_text(page)) {
+		return text_claim(page, false);
+	}
+	if (page_get_type(page) == VM_FILE) {
+		return mmap_claim(page, false);
+	}
+	struct frame *frame = vm_try_get_frame();
+	if (frame == NULL) {
+		return false;
+	}
+	return vm_do_claim_frame(page, frame);
+}
+
+/* Throws away the contents of PAGE for MADV_DONTNEED: the frame is
+ * released (mmap pages are written back first) and an anonymous page
+ * reads back as zeros on its next fault. Returns true if anything was
+ * dropped. */
+bool vm_page_discard(struct page *page)
+{
+	bool dropped = false;
+
+	if (page->frame != NULL) {
+		vm_free_frame(page);
+		dropped = true;
+	}
+	if (anon_discard(page)) {
+		dropped = true;
+	}
+	return dropped;
+}
+
+/* Maps PAGE to KVA in its owner's page table, which is not always the
+ * running thread's (see vm_prefetch_page()). */
+bool vm_install_page(struct page *page, void *kva, bool writable)
+{
+	uint64_t *pml4 = page->owner->pml4;
+
+	return pml4_get_page(pml4, page->va) == NULL
+		&& pml4_set_page(pml4, page->va, kva, writable);
 }
 
 /* Claim the PAGE and set up the mmu. */
@@ -339,20 +1175,47 @@ bool vm_claim_page(void *va UNUSED)
 static bool
 vm_do_claim_page(struct page *page)	
 { 
-	struct frame *frame = vm_get_frame();
+	return vm_do_claim_frame(page, vm_get_frame());
+}
+
+/* Returns what swapping PAGE in is going to cost, for faultstat. */
+static enum fault_kind
+vm_swap_in_kind(struct page *page)
+{
+	switch (VM_TYPE(page->operations->type)) {
+	case VM_UNINIT:
+		// init이 있으면 lazy_load_segment()로 파일에서 읽는다
+		return page->uninit.init != NULL || VM_TYPE(page->uninit.type) == VM_FILE
+			? FAULT_FILE : FAULT_MINOR;
+	case VM_ANON:
+		return page->anon.swap_location >= 0 || page->anon.zswap != NULL
+			? FAULT_SWAP_IN : FAULT_MINOR;
+	default:
+		return FAULT_FILE;
+	}
+}
+
+bool
+vm_do_claim_frame(struct page *page, struct frame *frame)
+{
+	// 모든 frame이 채워지는 중이면 policy가 victim을 못 찾고 NULL이 온다
+	if (frame == NULL) {
+		return false;
+	}
 	// frame과 page 연결
 	/* Set links */
-	frame->page = page;
+	vm_frame_set_page(frame, page);
 	page->frame = frame;
 
 	/* TODO: Insert page table entry to map page's VA to frame's PA. */
-	// install_page: page와 frame의 연결정보를 pml4에 추가하는 함수
+	// vm_install_page: page와 frame의 연결정보를 page 주인의 pml4에 추가하는 함수
 	// 페이지테이블에 frame과 page의 연결을 추가함
-	if (install_page(page->va, frame->kva, page->writable))
+	if (vm_install_page(page, frame->kva, page->writable))
 	{
 		// swap in: disk(swap area)에서 메모리로 데이터 가져옴
 		// page fault 나고 swap_in 실행 시 uninit_initializer가 실행됨
 		// uninit_initalizer에서 init에 있던 lazy_load_segment 호출되고, type에 맞는 initializer 호출됨
+		faultstat_note(vm_swap_in_kind(page));
 		return swap_in(page, frame->kva);	
 	}
 	return false;
@@ -365,17 +1228,45 @@ void supplemental_page_table_init(struct supplemental_page_table *spt UNUSED)
 {					
 	//-------project3-memory_management-start--------------									   
 	hash_init(&spt->spt_hash, page_hash, page_less, NULL);	   // 해시테이블 초기화
+	vma_tree_init(&spt->vmas);
+	list_init(&spt->madvise_regions);
+	ksm_enter(thread_current());	// memmerge() 중이면 새 주소 공간도 ksmd가 본다
+	vm_space_enter(thread_current());
 	//-------project3-memory_management-end----------------
 }
 
+/* Puts T on the list of address spaces. Called when T gets a new one. */
+void
+vm_space_enter(struct thread *t)
+{
+	bool locked = vm_lock_acquire();
+	list_push_back(&vm_spaces, &t->vm_elem);
+	vm_lock_release(locked);
+}
+
+/* Takes T off the list of address spaces before its pml4 goes away.
+ * Does nothing if T never got an address space, e.g. a failed fork. */
+void
+vm_space_leave(struct thread *t)
+{
+	bool locked = vm_lock_acquire();
+	if (t->vm_elem.next != NULL) {
+		list_remove(&t->vm_elem);
+		t->vm_elem.next = NULL;	// exec()이 다시 넣을 때까지 빠진 상태
+	}
+	vm_lock_release(locked);
+}
+
 /* Copy supplemental page table from src to dst */
 /* src spt를 dst spt에 복사한다.*/
 bool
 supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED, struct supplemental_page_table *src UNUSED) {
 	//----------------------------project3 anonymous page start-----------
+	bool locked = vm_lock_acquire();	// 부모 page가 도중에 evict되면 안 됨
+	bool success = madvise_copy(dst, src) && vma_tree_copy(&dst->vmas, &src->vmas);
 	struct hash_iterator i;
 	hash_first(&i, &src->spt_hash);
-	while (hash_next(&i)) // 해시테이블을 순회하며 src의 모든 페이지를 dst로 복붙.
+	while (success && hash_next(&i)) // 해시테이블을 순회하며 src의 모든 페이지를 dst로 복붙.
 	{
 		// 해시테이블의 elem에서 page 받아옴.
 		struct page* parent_page = hash_entry(hash_cur(&i), struct page, hash_elem);// 부모페이지
@@ -385,25 +1276,51 @@ supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED, struct
 		vm_initializer *init = parent_page->uninit.init; // 부모의 init함수
 		void* aux = parent_page->uninit.aux;	// load segment로부터 전달받은 container
 		
-		if (parent_page->operations->type == VM_UNINIT) {	// 부모 type이 uninit인 경우
+		if (page_is_text(parent_page)) {	// 공유 text page는 자식도 lazy하게 같은 frame을 공유
+			if(!vm_alloc_page_with_initializer(VM_ANON, upage, writable,
+					lazy_load_segment, parent_page->text.aux)) {
+				success = false;
+			}
+		}
+		else if (parent_type == VM_FILE) {	// mmap page는 자식의 vm_area에서 fault 때 새로 만든다
+			continue;	// (같은 파일의 page cache frame을 mmap_claim()에서 공유함, MAP_SHARED)
+		}
+		else if (anon_is_zero(parent_page)) {	// 0으로 쫓겨난 page는 자식도 처음부터 0
+			if(!vm_alloc_page(VM_ANON, upage, writable)) {
+				success = false;
+			}
+		}
+		else if (parent_page->operations->type == VM_UNINIT) {	// 부모 type이 uninit인 경우
 			if(!vm_alloc_page_with_initializer(parent_type, upage, writable, init, aux)) {
-				return false;
+				success = false;
 			}
 		}
 		else {	// 부모 type이 uninit이 아닌 경우
-			if(!vm_alloc_page(parent_type, upage, writable)) {	// uninit page를 만든다	
-				return false;
+			// 부모 page가 swap, zswap에 있거나 fill 값으로만 남아 있으면 먼저 올려둔다
+			if (parent_page->frame == NULL && !vm_do_claim_page(parent_page)) {
+				success = false;
+				break;
 			}
-			if(!vm_claim_page(upage)) {	// upage에 해당하는 frame을 할당받는다.
-				return false;
+			// 자식 frame을 구하다가 부모 page가 evict되지 않도록 그동안 frame을 비워둔 것처럼 표시
+			// (page가 없는 frame은 채우는 중인 frame이라 victim으로 고르지 않는다)
+			struct frame *parent_frame = parent_page->frame;
+			struct page *pinned = parent_frame->page;
+			vm_frame_set_page(parent_frame, NULL);
+			bool claimed = vm_alloc_page(parent_type, upage, writable) 	// uninit page를 만든다
+					&& vm_claim_page(upage);	// upage에 해당하는 frame을 할당받는다.
+			vm_frame_set_page(parent_frame, pinned);
+			if (!claimed) {
+				success = false;
+				break;
 			}
 
 			// 부모 page의 것을 자식 page에 memcpy한다. 
 			struct page* child_page = spt_find_page(dst, upage);
-			memcpy(child_page->frame->kva, parent_page->frame->kva, PGSIZE);
+			memcpy(child_page->frame->kva, parent_frame->kva, PGSIZE);
 		}
 	}
-	return true;
+	vm_lock_release(locked);
+	return success;
 	//----------------------------project3 anonymous page end-----------
 }
 
@@ -413,15 +1330,24 @@ supplemental_page_table_kill (struct supplemental_page_table *spt UNUSED) {
 	/* TODO: Destroy all the supplemental_page_table hold by thread and
 	 * TODO: writeback all the modified contents to the storage. */ // -> munmap
 	//----------------------------project3 anonymous page start-----------
+	bool locked = vm_lock_acquire();
+	madvise_kill(spt);	// 아직 처리 안 된 prefetch 요청도 취소
 	struct hash_iterator i;
 	hash_first(&i, &spt->spt_hash);
+	// frame을 frame_table에서 빼고 돌려준다. 안 그러면 죽은 프로세스의 page가 evict 대상이 됨
+	// (mmap page는 destroy에서 write back하면서 같이 정리됨)
 	while(hash_next(&i)) {
 		struct page *target = hash_entry(hash_cur(&i), struct page, hash_elem);
-		if(target->operations->type == VM_FILE) {
-			do_munmap(target->va);	// type이 file인 경우 munmap도 해야 함	
+		if (target->frame != NULL && target->operations->type != VM_FILE) {
+			vm_free_frame(target);
+		}
+		else if (vm_zero_mapped(target)) {
+			pml4_clear_page(target->owner->pml4, target->va);	// pml4_destroy()가 zero frame을 free하지 않도록
 		}
 	}
 	hash_destroy(&spt->spt_hash, hash_destructor);	// spt 삭제
+	vma_tree_destroy(&spt->vmas);	// mmap page가 모두 write back된 뒤에 파일을 닫는다
+	vm_lock_release(locked);
 	//----------------------------project3 anonymous page end-----------
 
 }
@@ -0,0 +1,227 @@
+/* vma.c: Interval tree of a process's mapped regions.
+ *
+ * mmap()은 page마다 struct page와 container를 미리 만드는 대신 구간 하나만
+ * 기록하고, page는 그 구간 안에서 fault가 났을 때 만든다. 구간들은 start 순의
+ * AVL tree에 두고 각 node에 subtree의 최대 end를 유지해서 주소로 찾기와
+ * 겹치는 구간 찾기를 모두 O(log n)에 한다. */
+
+#include "vm/vma.h"
+#include <debug.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+
+static int height (struct vm_area *n);
+static void update (struct vm_area *n);
+static struct vm_area *balance (struct vm_area *n);
+static struct vm_area *insert_node (struct vm_area *n, struct vm_area *vma);
+static struct vm_area *remove_node (struct vm_area *n, struct vm_area *vma);
+static struct vm_area *remove_min (struct vm_area *n, struct vm_area **min);
+static bool copy (struct vma_tree *dst, struct vm_area *n);
+static void destroy (struct vm_area *n);
+
+void
+vma_tree_init (struct vma_tree *tree) {
+	tree->root = NULL;
+	tree->cnt = 0;
+}
+
+/* Inserts VMA, which must not overlap any region in TREE. */
+void
+vma_insert (struct vma_tree *tree, struct vm_area *vma) {
+	ASSERT (vma_overlap (tree, vma->start, vma->end) == NULL);
+
+	vma->left = vma->right = NULL;
+	update (vma);
+	tree->root = insert_node (tree->root, vma);
+	tree->cnt++;
+}
+
+/* Removes VMA from TREE without freeing it. */
+void
+vma_remove (struct vma_tree *tree, struct vm_area *vma) {
+	tree->root = remove_node (tree->root, vma);
+	tree->cnt--;
+}
+
+/* Returns the region containing ADDR, or a null pointer. */
+struct vm_area *
+vma_find (struct vma_tree *tree, const void *addr) {
+	struct vm_area *n = tree->root;
+
+	while (n != NULL) {
+		if (addr < n->start)
+			n = n->left;
+		else if (addr >= n->end)
+			n = n->right;
+		else
+			return n;
+	}
+	return NULL;
+}
+
+/* Returns a region that overlaps [START, END), or a null pointer. */
+struct vm_area *
+vma_overlap (struct vma_tree *tree, const void *start, const void *end) {
+	struct vm_area *n = tree->root;
+
+	while (n != NULL) {
+		if (n->start < end && start < n->end)
+			return n;
+		// 왼쪽에 start보다 늦게 끝나는 구간이 있으면 겹치는 구간은 거기에만 있을 수 있다
+		if (n->left != NULL && n->left->max_end > start)
+			n = n->left;
+		else
+			n = n->right;
+	}
+	return NULL;
+}
+
+/* Copies every region of SRC into DST for fork(). Each copy opens its
+ * own handle on the file. */
+bool
+vma_tree_copy (struct vma_tree *dst, struct vma_tree *src) {
+	return copy (dst, src->root);
+}
+
+/* Frees every region in TREE. The pages in them must already be gone. */
+void
+vma_tree_destroy (struct vma_tree *tree) {
+	destroy (tree->root);
+	vma_tree_init (tree);
+}
+
+/* Closes VMA's file and frees it. */
+void
+vma_free (struct vm_area *vma) {
+	file_close (vma->file);
+	free (vma);
+}
+
+static int
+height (struct vm_area *n) {
+	return n != NULL ? n->height : 0;
+}
+
+/* Recomputes N's height and max_end from its children. */
+static void
+update (struct vm_area *n) {
+	int hl = height (n->left), hr = height (n->right);
+
+	n->height = (hl > hr ? hl : hr) + 1;
+	n->max_end = n->end;
+	if (n->left != NULL && n->left->max_end > n->max_end)
+		n->max_end = n->left->max_end;
+	if (n->right != NULL && n->right->max_end > n->max_end)
+		n->max_end = n->right->max_end;
+}
+
+static struct vm_area *
+rotate_right (struct vm_area *n) {
+	struct vm_area *l = n->left;
+
+	n->left = l->right;
+	l->right = n;
+	update (n);
+	update (l);
+	return l;
+}
+
+static struct vm_area *
+rotate_left (struct vm_area *n) {
+	struct vm_area *r = n->right;
+
+	n->right = r->left;
+	r->left = n;
+	update (n);
+	update (r);
+	return r;
+}
+
+/* Restores the AVL property at N and returns the new subtree root. */
+static struct vm_area *
+balance (struct vm_area *n) {
+	int diff = height (n->left) - height (n->right);
+
+	update (n);
+	if (diff > 1) {
+		if (height (n->left->left) < height (n->left->right))
+			n->left = rotate_left (n->left);
+		return rotate_right (n);
+	}
+	if (diff < -1) {
+		if (height (n->right->right) < height (n->right->left))
+			n->right = rotate_right (n->right);
+		return rotate_left (n);
+	}
+	return n;
+}
+
+static struct vm_area *
+insert_node (struct vm_area *n, struct vm_area *vma) {
+	if (n == NULL)
+		return vma;
+	if (vma->start < n->start)
+		n->left = insert_node (n->left, vma);
+	else
+		n->right = insert_node (n->right, vma);
+	return balance (n);
+}
+
+/* Detaches the leftmost node of N into *MIN. */
+static struct vm_area *
+remove_min (struct vm_area *n, struct vm_area **min) {
+	if (n->left == NULL) {
+		*min = n;
+		return n->right;
+	}
+	n->left = remove_min (n->left, min);
+	return balance (n);
+}
+
+static struct vm_area *
+remove_node (struct vm_area *n, struct vm_area *vma) {
+	ASSERT (n != NULL);
+
+	if (vma->start < n->start)
+		n->left = remove_node (n->left, vma);
+	else if (vma->start > n->start)
+		n->right = remove_node (n->right, vma);
+	else {
+		// node를 옮기지 않고 연결만 바꾼다 (caller가 vm_area 포인터를 들고 있음)
+		struct vm_area *min;
+		if (n->right == NULL)
+			return n->left;
+		n->right = remove_min (n->right, &min);
+		min->left = n->left;
+		min->right = n->right;
+		return balance (min);
+	}
+	return balance (n);
+}
+
+static bool
+copy (struct vma_tree *dst, struct vm_area *n) {
+	if (n == NULL)
+		return true;
+
+	struct vm_area *vma = malloc (sizeof *vma);
+	if (vma == NULL)
+		return false;
+	*vma = *n;
+	vma->file = file_reopen (n->file);
+	if (vma->file == NULL) {
+		free (vma);
+		return false;
+	}
+	vma_insert (dst, vma);
+	return copy (dst, n->left) && copy (dst, n->right);
+}
+
+static void
+destroy (struct vm_area *n) {
+	if (n == NULL)
+		return;
+	destroy (n->left);
+	destroy (n->right);
+	vma_free (n);
+}
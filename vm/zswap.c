@@ -0,0 +1,300 @@
+/* zswap.c: Compressed in-memory cache in front of the swap disk.
+ *
+ * anon_swap_out()은 페이지를 바로 swap disk에 쓰기 전에 먼저 여기에 넣어본다.
+ * 페이지를 LZ 방식으로 압축해서 kernel pool에서 받아온 arena에 보관하고,
+ * 압축이 잘 안 되는 페이지는 거절해서 원래대로 disk로 가게 한다.
+ * arena가 가득 차면 가장 오래된 entry부터 disk로 write back 한다.
+ * RAM에서 swap in 되는 페이지는 disk I/O를 전혀 하지 않는다. */
+
+#include "vm/zswap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+
+#define ZSWAP_ARENA_PAGES 64		/* arena 크기 (kernel pool 페이지 수) */
+#define ZSWAP_CHUNK_SIZE 64			/* arena 할당 단위 (byte) */
+#define ZSWAP_CHUNK_CNT (ZSWAP_ARENA_PAGES * PGSIZE / ZSWAP_CHUNK_SIZE)
+#define ZSWAP_MAX_STORE (PGSIZE * 3 / 4)	/* 이보다 크게 압축되면 disk로 보낸다 */
+
+/* LZ 압축 포맷.
+ * 0xxxxxxx            : 뒤따르는 (x + 1)개의 literal byte
+ * 1xxxxxxx off0 off1  : (x + LZ_MIN_MATCH) byte를 off만큼 앞에서 복사 */
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_MATCH (0x7f + LZ_MIN_MATCH)
+#define LZ_MAX_LITERAL 0x80
+#define LZ_HASH_BITS 10
+
+/* 압축되어 arena에 있는 페이지 하나. */
+struct zswap_entry {
+	struct page *page;			/* 이 entry를 가지고 있는 anon page */
+	size_t chunk;				/* arena 안의 시작 chunk 번호 */
+	size_t len;					/* 압축된 길이 (byte) */
+	struct list_elem lru_elem;	/* lru_list의 element */
+};
+
+static uint8_t *arena;				/* 압축된 페이지들이 들어가는 공간 */
+static struct bitmap *chunk_map;	/* arena chunk 사용 여부 */
+static struct list lru_list;		/* 오래된 entry가 앞쪽 */
+static struct lock zswap_lock;
+static void *writeback_page;		/* write back 할 때 압축을 푸는 bounce page */
+
+/* lz_compress()가 쓰는 버퍼들. zswap_lock으로 보호한다. */
+static uint8_t scratch[ZSWAP_MAX_STORE];
+static uint16_t lz_table[1 << LZ_HASH_BITS];
+
+/* Statistics. */
+static long long stored_cnt;		/* RAM에 저장한 페이지 수 */
+static long long rejected_cnt;		/* 압축이 안 돼서 disk로 보낸 페이지 수 */
+static long long load_cnt;			/* RAM에서 바로 swap in 한 페이지 수 */
+static long long writeback_cnt;		/* arena가 가득 차서 disk로 내린 페이지 수 */
+
+static size_t lz_compress (const uint8_t *src, uint8_t *dst, size_t cap);
+static bool lz_decompress (const uint8_t *src, size_t len, uint8_t *dst);
+static bool zswap_writeback_lru (void);
+static void zswap_free_entry (struct zswap_entry *e);
+
+/* Sets up the arena. If the kernel pool cannot spare the arena, zswap is
+ * disabled and every swap out goes straight to the disk. */
+void
+zswap_init (void) {
+	list_init (&lru_list);
+	lock_init (&zswap_lock);
+
+	arena = palloc_get_multiple (0, ZSWAP_ARENA_PAGES);
+	writeback_page = palloc_get_page (0);
+	chunk_map = bitmap_create (ZSWAP_CHUNK_CNT);
+	if (arena == NULL || writeback_page == NULL || chunk_map == NULL) {
+		palloc_free_multiple (arena, ZSWAP_ARENA_PAGES);
+		palloc_free_page (writeback_page);
+		if (chunk_map != NULL)
+			bitmap_destroy (chunk_map);
+		arena = NULL;
+		printf ("zswap: arena allocation failed, disabled\n");
+	}
+}
+
+/* Compresses the page at KVA into the arena on behalf of PAGE.
+ * Returns false if the page did not compress well enough or the arena
+ * has no room even after writing old entries back; the caller must then
+ * write the page to the swap disk itself. */
+bool
+zswap_store (struct page *page, const void *kva) {
+	struct zswap_entry *e;
+	size_t len, chunk_cnt, idx;
+
+	if (arena == NULL)
+		return false;
+
+	lock_acquire (&zswap_lock);
+	len = lz_compress (kva, scratch, sizeof scratch);
+	if (len == 0) {
+		rejected_cnt++;
+		lock_release (&zswap_lock);
+		return false;
+	}
+
+	// 연속된 chunk를 찾을 때까지 LRU entry를 disk로 내린다.
+	chunk_cnt = DIV_ROUND_UP (len, ZSWAP_CHUNK_SIZE);
+	while ((idx = bitmap_scan_and_flip (chunk_map, 0, chunk_cnt, false))
+			== BITMAP_ERROR)
+		if (!zswap_writeback_lru ()) {
+			lock_release (&zswap_lock);
+			return false;
+		}
+
+	e = malloc (sizeof *e);
+	if (e == NULL) {
+		bitmap_set_multiple (chunk_map, idx, chunk_cnt, false);
+		lock_release (&zswap_lock);
+		return false;
+	}
+	memcpy (arena + idx * ZSWAP_CHUNK_SIZE, scratch, len);
+	e->page = page;
+	e->chunk = idx;
+	e->len = len;
+	list_push_back (&lru_list, &e->lru_elem);
+	page->anon.zswap = e;
+	stored_cnt++;
+	lock_release (&zswap_lock);
+	return true;
+}
+
+/* Decompresses PAGE's entry into KVA and drops the entry.
+ * Returns false if PAGE has no entry in the arena, e.g. because it was
+ * just written back to the swap disk; the caller then reads the page
+ * from its swap slot. */
+bool
+zswap_load (struct page *page, void *kva) {
+	struct zswap_entry *e;
+
+	lock_acquire (&zswap_lock);
+	e = page->anon.zswap;
+	if (e == NULL) {
+		lock_release (&zswap_lock);
+		return false;
+	}
+	// 압축을 못 풀면 page 내용이 사라지므로 write back할 때처럼 멈춘다
+	if (!lz_decompress (arena + e->chunk * ZSWAP_CHUNK_SIZE, e->len, kva))
+		PANIC ("zswap: corrupted entry for page %p", page->va);
+	zswap_free_entry (e);
+	load_cnt++;
+	lock_release (&zswap_lock);
+	return true;
+}
+
+/* Drops PAGE's entry, if any, without reading it. */
+void
+zswap_invalidate (struct page *page) {
+	lock_acquire (&zswap_lock);
+	if (page->anon.zswap != NULL)
+		zswap_free_entry (page->anon.zswap);
+	lock_release (&zswap_lock);
+}
+
+void
+zswap_print_stats (void) {
+	printf ("Zswap: %lld stored, %lld rejected, %lld loads, %lld written back\n",
+			stored_cnt, rejected_cnt, load_cnt, writeback_cnt);
+}
+
+/* Writes the least recently stored entry to the swap disk and frees its
+ * chunks. Returns false if there is nothing to write back or the swap
+ * disk is full. Must be called with zswap_lock held. */
+static bool
+zswap_writeback_lru (void) {
+	struct zswap_entry *e;
+	size_t slot;
+
+	ASSERT (lock_held_by_current_thread (&zswap_lock));
+	if (list_empty (&lru_list))
+		return false;
+
+	e = list_entry (list_front (&lru_list), struct zswap_entry, lru_elem);
+	if (!lz_decompress (arena + e->chunk * ZSWAP_CHUNK_SIZE, e->len,
+				writeback_page))
+		PANIC ("zswap: corrupted entry for page %p", e->page->va);
+	slot = swap_slot_write (writeback_page);
+	if (slot == BITMAP_ERROR)
+		return false;
+
+	// 이제 이 페이지는 disk의 slot에서 swap in 된다.
+	e->page->anon.swap_location = slot;
+	zswap_free_entry (e);
+	writeback_cnt++;
+	return true;
+}
+
+/* Returns E's chunks to the arena and detaches it from its page. */
+static void
+zswap_free_entry (struct zswap_entry *e) {
+	bitmap_set_multiple (chunk_map, e->chunk,
+			DIV_ROUND_UP (e->len, ZSWAP_CHUNK_SIZE), false);
+	list_remove (&e->lru_elem);
+	e->page->anon.zswap = NULL;
+	free (e);
+}
+
+static inline uint32_t
+lz_load32 (const uint8_t *p) {
+	uint32_t v;
+	memcpy (&v, p, sizeof v);
+	return v;
+}
+
+/* Emits SRC[START, END) as literal runs at DST + *OPP and advances *OPP.
+ * Returns false if the output does not fit in CAP bytes. */
+static bool
+lz_emit_literals (const uint8_t *src, size_t start, size_t end,
+		uint8_t *dst, size_t *opp, size_t cap) {
+	size_t op = *opp;
+
+	while (start < end) {
+		size_t n = end - start < LZ_MAX_LITERAL ? end - start : LZ_MAX_LITERAL;
+		if (op + 1 + n > cap)
+			return false;
+		dst[op++] = n - 1;
+		memcpy (dst + op, src + start, n);
+		op += n;
+		start += n;
+	}
+	*opp = op;
+	return true;
+}
+
+/* Compresses one page at SRC into DST. Returns the compressed length, or 0
+ * if the result would exceed CAP bytes. */
+static size_t
+lz_compress (const uint8_t *src, uint8_t *dst, size_t cap) {
+	size_t ip = 0, op = 0, lit = 0;
+
+	memset (lz_table, 0, sizeof lz_table);
+	while (ip + LZ_MIN_MATCH <= PGSIZE) {
+		uint32_t seq = lz_load32 (src + ip);
+		size_t h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+		size_t cand = lz_table[h];		/* 위치 + 1, 0이면 없음 */
+
+		lz_table[h] = ip + 1;
+		if (cand == 0 || lz_load32 (src + cand - 1) != seq) {
+			ip++;
+			continue;
+		}
+		cand--;
+
+		size_t len = LZ_MIN_MATCH;
+		while (ip + len < PGSIZE && len < LZ_MAX_MATCH
+				&& src[cand + len] == src[ip + len])
+			len++;
+
+		if (!lz_emit_literals (src, lit, ip, dst, &op, cap) || op + 3 > cap)
+			return 0;
+		dst[op++] = 0x80 | (len - LZ_MIN_MATCH);
+		dst[op++] = (ip - cand) & 0xff;
+		dst[op++] = (ip - cand) >> 8;
+		ip += len;
+		lit = ip;
+	}
+	if (!lz_emit_literals (src, lit, PGSIZE, dst, &op, cap))
+		return 0;
+	return op;
+}
+
+/* Decompresses LEN bytes at SRC into the page at DST.
+ * Returns true if exactly one page was produced. */
+static bool
+lz_decompress (const uint8_t *src, size_t len, uint8_t *dst) {
+	size_t ip = 0, op = 0;
+
+	while (ip < len) {
+		uint8_t c = src[ip++];
+		if (c & 0x80) {
+			size_t n = (c & 0x7f) + LZ_MIN_MATCH;
+			size_t off;
+			if (ip + 2 > len)
+				return false;
+			off = src[ip] | (src[ip + 1] << 8);
+			ip += 2;
+			if (off == 0 || off > op || op + n > PGSIZE)
+				return false;
+			/* 겹치는 복사가 가능하므로 한 byte씩 복사한다. */
+			for (; n > 0; n--, op++)
+				dst[op] = dst[op - off];
+		} else {
+			size_t n = c + 1;
+			if (ip + n > len || op + n > PGSIZE)
+				return false;
+			memcpy (dst + op, src + ip, n);
+			ip += n;
+			op += n;
+		}
+	}
+	return op == PGSIZE;
+}